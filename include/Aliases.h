@@ -15,11 +15,21 @@ namespace Geometry
     using Vector2f = TVector2<float>;
     using Vector2i = TVector2<int>;
 
+    // Define GEOMETRY_SINGLE_PRECISION to store vertices, normals and texture coordinates as float, which halves the
+    // memory of large (display only) meshes. Bounding shapes, transformations and the file formats stay double.
+#ifdef GEOMETRY_SINGLE_PRECISION
+    using Vertex = Vector3f;
+#else
     using Vertex = Vector3d;
+#endif
     using VertexPtr = std::shared_ptr<Vertex>;
     using VertexRaw = raw_ptr<Vertex>;
 
+#ifdef GEOMETRY_SINGLE_PRECISION
+    using Normal = Vector3f;
+#else
     using Normal = Vector3d;
+#endif
     using NormalPtr = std::shared_ptr<Normal>;
     using NormalRaw = raw_ptr<Normal>;
 
@@ -48,7 +58,11 @@ namespace Geometry
     using ShapePtr = std::shared_ptr<Shape>;
     using ShapeRaw = raw_ptr<Shape>;
 
+#ifdef GEOMETRY_SINGLE_PRECISION
+    using TextureCoord = Vector2f;
+#else
     using TextureCoord = Vector2d;
+#endif
     using TextureCoordPtr = std::shared_ptr<TextureCoord>;
     using TextureCoordRaw = raw_ptr<TextureCoord>;
 
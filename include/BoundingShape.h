@@ -15,9 +15,20 @@ namespace Geometry
 
         enum class Type : unsigned char
         {
-            Unknown = 1,
-            Ball    = 2,
-            Box     = 3
+            Unknown     = 1,
+            Ball        = 2,
+            Box         = 3,
+            OrientedBox = 4
+        };
+        typedef std::array<vector_type, dimension> axes_type;
+
+        // Accuracy of a calculated Ball. Exact is the smallest enclosing ball (Miniball); Approximate takes linear
+        // time (Ritter) and is typically 5-20% larger. A Box is always exact, an OrientedBox never is (its axes are
+        // the principal axes of the points, see SetOrientedBox).
+        enum class Accuracy : unsigned char
+        {
+            Exact,
+            Approximate
         };
 
         TBoundingShape()
@@ -36,6 +47,10 @@ namespace Geometry
         {
             Set(center, radius, optimal);
         }
+        TBoundingShape(const vector_type &center, const axes_type &axes, const vector_type &halfExtents, const bool optimal = false)
+        {
+            Set(center, axes, halfExtents, optimal);
+        }
 
         void Clear()
         {
@@ -65,6 +80,16 @@ namespace Geometry
             m_type = Type::Ball;
         }
 
+        // axes have to be orthonormal, halfExtents[i] is half the size of the box along axes[i]
+        void Set(const vector_type &center, const axes_type &axes, const vector_type &halfExtents, const bool optimal = false)
+        {
+            orientedBox.m_center = center;
+            orientedBox.m_axes = axes;
+            orientedBox.m_halfExtents = halfExtents;
+            m_optimal = optimal;
+            m_type = Type::OrientedBox;
+        }
+
         Type GetType() const { return m_type; }
 
     private:
@@ -75,9 +100,33 @@ namespace Geometry
             typedef Cit_ Cit;
             inline  Cit operator() (Pit it) const { return (Cit)(*(*it)).GetData(); }
         };
+        template<typename ITERATOR>
+        void SetMiniball(ITERATOR itBegin, ITERATOR itEnd, std::true_type)
+        {
+            Miniball::Miniball<MyCoordAccessor<ITERATOR, value_type*> > mb(dimension, itBegin, itEnd);
+            vector_type v(mb.center());
+            Set(v, sqrt(mb.squared_radius()));
+        }
+        // points of another precision are converted first, Miniball works on the coordinates in place
+        template<typename ITERATOR>
+        void SetMiniball(ITERATOR itBegin, ITERATOR itEnd, std::false_type)
+        {
+            std::vector<vector_type> points;
+            for (ITERATOR it = itBegin; it != itEnd; ++it)
+            {
+                points.emplace_back(**it);
+            }
+            std::vector<vector_type*> pointers;
+            pointers.reserve(points.size());
+            for (vector_type& point : points)
+            {
+                pointers.emplace_back(&point);
+            }
+            SetMiniball(pointers.begin(), pointers.end(), std::true_type());
+        }
     public:
         template<typename ITERATOR>
-        void Set(const Type type, ITERATOR itBegin, ITERATOR itEnd)
+        void Set(const Type type, ITERATOR itBegin, ITERATOR itEnd, const Accuracy accuracy = Accuracy::Exact)
         {
             switch (type)
             {
@@ -85,10 +134,14 @@ namespace Geometry
                 m_type = type;
                 break;
             case Type::Ball:
+                if (accuracy == Accuracy::Approximate)
                 {
-                    Miniball::Miniball<MyCoordAccessor<ITERATOR, vector_type::value_type*> > mb(vector_type::dimension, itBegin, itEnd);
-                    vector_type v(mb.center());
-                    Set(v, sqrt(mb.squared_radius()));
+                    SetApproximateBall(itBegin, itEnd);
+                }
+                else
+                {
+                    typedef typename std::decay<decltype(**itBegin)>::type point_type;
+                    SetMiniball(itBegin, itEnd, std::is_same<typename point_type::value_type, value_type>());
                 }
                 break;
             case Type::Box:
@@ -105,7 +158,198 @@ namespace Geometry
                             if (v[i] > vmax[i]) vmax[i] = v[i];
                         }
                     }
-                    Set(vmin, vmax, m_optimal);
+                    Set(vmin, vmax, true);
+                }
+                break;
+            case Type::OrientedBox:
+                SetOrientedBox(itBegin, itEnd);
+                break;
+            }
+        }
+
+        // radius of the approximate ball relative to the exact ball (>= 1)
+        template<typename ITERATOR>
+        static double BallTightness(ITERATOR itBegin, ITERATOR itEnd)
+        {
+            this_type exact, approximate;
+            exact.Set(Type::Ball, itBegin, itEnd, Accuracy::Exact);
+            approximate.Set(Type::Ball, itBegin, itEnd, Accuracy::Approximate);
+            return approximate.GetRadius() / exact.GetRadius();
+        }
+
+        // Grow to enclose other as well, keeping the type (an uninitialized shape becomes a copy of other). A Box
+        // around optimal boxes is optimal, a grown Ball isn't.
+        void Enclose(const this_type& other)
+        {
+            if (!other.IsInitialized())
+            {
+                return;
+            }
+            if (!IsInitialized())
+            {
+                Copy(other);
+                return;
+            }
+            this_type converted(other);
+            switch (m_type)
+            {
+            default:
+                assert(false);
+            case Type::Box:
+                {
+                    converted.Convert(Type::Box);
+                    vector_type vmin = box.m_min, vmax = box.m_max;
+                    for (index_type i = 0; i < dimension; ++i)
+                    {
+                        vmin[i] = std::min(vmin[i], converted.box.m_min[i]);
+                        vmax[i] = std::max(vmax[i], converted.box.m_max[i]);
+                    }
+                    Set(vmin, vmax, m_optimal && converted.m_optimal);
+                }
+                break;
+            case Type::Ball:
+                {
+                    converted.Convert(Type::Ball);
+                    const Ball& added = converted.ball;
+                    const value_type d = Distance(ball.m_center, added.m_center);
+                    if (d + added.m_radius <= ball.m_radius)
+                    {
+                        // other is inside
+                    }
+                    else if (d + ball.m_radius <= added.m_radius)
+                    {
+                        Copy(converted);
+                    }
+                    else
+                    {
+                        // the ball touching both balls on the far sides, inflated for rounding
+                        const value_type radius = (d + ball.m_radius + added.m_radius) / 2;
+                        const vector_type center = ball.m_center + (added.m_center - ball.m_center) * ((radius - ball.m_radius) / d);
+                        Set(center, radius * (1 + 16 * std::numeric_limits<value_type>::epsilon()), false);
+                    }
+                }
+                break;
+            case Type::OrientedBox:
+                Convert(Type::Box);
+                Enclose(converted);
+                Convert(Type::OrientedBox);
+                break;
+            }
+        }
+
+        // Move every side outward by distance; the result isn't optimal (unless distance is 0)
+        void Grow(const value_type distance)
+        {
+            if (distance == 0)
+            {
+                return;
+            }
+            switch (m_type)
+            {
+            default:
+                return;
+            case Type::Box:
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    box.m_min[i] -= distance;
+                    box.m_max[i] += distance;
+                }
+                break;
+            case Type::Ball:
+                ball.m_radius += distance;
+                break;
+            case Type::OrientedBox:
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    orientedBox.m_halfExtents[i] += distance;
+                }
+                break;
+            }
+            m_optimal = false;
+        }
+
+        // Transformations in O(1). Similarity transformations keep the smallest ball the smallest and an axis aligned
+        // box the tightest box, except for rotation: a rotated Box becomes the box around it and is no longer
+        // optimal. Use the calculation on the points to get an optimal bounding shape again.
+        void Scale(const value_type factor)
+        {
+            switch (m_type)
+            {
+            default:
+                break;
+            case Type::Box:
+                Set(box.m_min * factor, box.m_max * factor, m_optimal);
+                break;
+            case Type::Ball:
+                ball.m_center *= factor;
+                ball.m_radius *= std::abs(factor);
+                break;
+            case Type::OrientedBox:
+                orientedBox.m_center *= factor;
+                orientedBox.m_halfExtents *= std::abs(factor);
+                break;
+            }
+        }
+        void Translate(const vector_type& translation)
+        {
+            switch (m_type)
+            {
+            default:
+                break;
+            case Type::Box:
+                box.m_min += translation;
+                box.m_max += translation;
+                break;
+            case Type::Ball:
+                ball.m_center += translation;
+                break;
+            case Type::OrientedBox:
+                orientedBox.m_center += translation;
+                break;
+            }
+        }
+        template<typename VECTOR_TYPE = vector_type>
+        typename std::enable_if<3 == VECTOR_TYPE::dimension, void>::type
+        Rotate(const TQuaternion<value_type>& rotation)
+        {
+            switch (m_type)
+            {
+            default:
+                break;
+            case Type::Box:
+                {
+                    // half size along coordinate i is the sum of the projections of the rotated half axes
+                    const vector_type center = rotation.Transform(Middle(box.m_min, box.m_max));
+                    const vector_type halfSize = (box.m_max - box.m_min) / 2;
+                    vector_type offset;
+                    offset.Fill(0);
+                    for (index_type k = 0; k < dimension; ++k)
+                    {
+                        vector_type axis;
+                        axis.Fill(0);
+                        axis[k] = 1;
+                        axis = rotation.Transform(axis);
+                        for (index_type i = 0; i < dimension; ++i)
+                        {
+                            offset[i] += std::abs(axis[i]) * halfSize[k];
+                        }
+                    }
+                    // the rotated points end up just outside due to rounding
+                    for (index_type i = 0; i < dimension; ++i)
+                    {
+                        offset[i] += (std::abs(center[i]) + offset[i]) * 16 * std::numeric_limits<value_type>::epsilon();
+                    }
+                    Set(center - offset, center + offset, false);
+                }
+                break;
+            case Type::Ball:
+                ball.m_center = rotation.Transform(ball.m_center);
+                break;
+            case Type::OrientedBox:
+                orientedBox.m_center = rotation.Transform(orientedBox.m_center);
+                for (index_type k = 0; k < dimension; ++k)
+                {
+                    orientedBox.m_axes[k] = rotation.Transform(orientedBox.m_axes[k]);
                 }
                 break;
             }
@@ -126,6 +370,7 @@ namespace Geometry
             case Type::Unknown: return other.m_type == Type::Unknown;
             case Type::Box: return other.m_type == Type::Box && other.GetMin()==GetMin() && other.GetMax()==other.GetMax() && (other.IsOptimal()==IsOptimal());
             case Type::Ball: return other.m_type == Type::Ball && other.GetCenter() == GetCenter() && other.GetRadius() == other.GetRadius() && (other.IsOptimal() == IsOptimal());
+            case Type::OrientedBox: return other.m_type == Type::OrientedBox && other.GetCenter() == GetCenter() && other.GetAxes() == GetAxes() && other.GetHalfExtents() == GetHalfExtents() && (other.IsOptimal() == IsOptimal());
             }
         }
 
@@ -154,6 +399,13 @@ namespace Geometry
                             m_type = type;
                         }
                         return;
+                    case Type::OrientedBox:
+                        {
+                            vector_type halfExtents;
+                            halfExtents.Fill(ball.m_radius);
+                            Set(ball.m_center, IdentityAxes(), halfExtents, false);
+                        }
+                        return;
                     }
                     break;
                 case Type::Box:
@@ -163,12 +415,60 @@ namespace Geometry
                         {
                             Ball newBall;
                             newBall.m_center = Middle(box.m_min, box.m_max);
-                            newBall.m_radius = Distance(box.m_min, box.m_max) / 2;
+                            // the corners end up just outside due to rounding
+                            newBall.m_radius = Distance(box.m_min, box.m_max) / 2 * (1 + 16 * std::numeric_limits<value_type>::epsilon());
+                            ball = newBall;
+                            m_optimal = false;
+                            m_type = type;
+                        }
+                        return;
+                    case Type::OrientedBox:
+                        {
+                            const OrientedBox newOrientedBox = ToOrientedBox(box);
+                            orientedBox = newOrientedBox;
+                            m_optimal = false;
+                            m_type = type;
+                        }
+                        return;
+                    }
+                    break;
+                case Type::OrientedBox:
+                    switch (type)
+                    {
+                    case Type::Ball:
+                        {
+                            Ball newBall;
+                            newBall.m_center = orientedBox.m_center;
+                            newBall.m_radius = orientedBox.m_halfExtents.Length() * (1 + 16 * std::numeric_limits<value_type>::epsilon());
                             ball = newBall;
                             m_optimal = false;
                             m_type = type;
                         }
                         return;
+                    case Type::Box:
+                        {
+                            // extent along coordinate i is the sum of the projections of the half axes
+                            vector_type offset;
+                            offset.Fill(0);
+                            for (index_type k = 0; k < dimension; ++k)
+                            {
+                                for (index_type i = 0; i < dimension; ++i)
+                                {
+                                    offset[i] += std::abs(orientedBox.m_axes[k][i]) * orientedBox.m_halfExtents[k];
+                                }
+                            }
+                            for (index_type i = 0; i < dimension; ++i)
+                            {
+                                offset[i] += (std::abs(orientedBox.m_center[i]) + offset[i]) * 16 * std::numeric_limits<value_type>::epsilon();
+                            }
+                            Box newBox;
+                            newBox.m_min = orientedBox.m_center - offset;
+                            newBox.m_max = orientedBox.m_center + offset;
+                            box = newBox;
+                            m_optimal = false;
+                            m_type = type;
+                        }
+                        return;
                     }
                     break;
                 }
@@ -188,6 +488,8 @@ namespace Geometry
                 assert(false);
             case Type::Ball:
                 break;
+            case Type::OrientedBox:
+                return orientedBox.m_center;
             }
             return ball.m_center;
         }
@@ -230,6 +532,16 @@ namespace Geometry
             }
             return box.m_max;
         }
+        axes_type GetAxes() const
+        {
+            assert(m_type == Type::OrientedBox);
+            return orientedBox.m_axes;
+        }
+        vector_type GetHalfExtents() const
+        {
+            assert(m_type == Type::OrientedBox);
+            return orientedBox.m_halfExtents;
+        }
 
         void Copy(const this_type &other)
         {
@@ -245,11 +557,33 @@ namespace Geometry
                 ball.m_center = other.ball.m_center;
                 ball.m_radius = other.ball.m_radius;
                 break;
+            case Type::OrientedBox:
+                orientedBox.m_center = other.orientedBox.m_center;
+                orientedBox.m_axes = other.orientedBox.m_axes;
+                orientedBox.m_halfExtents = other.orientedBox.m_halfExtents;
+                break;
             }
         }
 
         bool Touches(const this_type &other) const
         {
+            if (m_type == Type::OrientedBox || other.m_type == Type::OrientedBox)
+            {
+                // separating axis tests, a Box is handled as an OrientedBox
+                const OrientedBox& b0 = m_type == Type::OrientedBox ? orientedBox : other.orientedBox;
+                const this_type& rest = m_type == Type::OrientedBox ? other : *this;
+                switch (rest.m_type)
+                {
+                default:
+                    assert(false);
+                case Type::OrientedBox:
+                    return Touches(b0, rest.orientedBox);
+                case Type::Box:
+                    return Touches(b0, ToOrientedBox(rest.box));
+                case Type::Ball:
+                    return Touches(b0, rest.ball);
+                }
+            }
             if (m_type == other.m_type)
             {
                 switch (m_type)
@@ -286,8 +620,16 @@ namespace Geometry
                 return Encapsulates(box, value);
             case Type::Ball:
                 return Encapsulates(ball, value);
+            case Type::OrientedBox:
+                return Encapsulates(orientedBox, value);
             }
         }
+        // point of another precision, e.g. a Vertex with GEOMETRY_SINGLE_PRECISION
+        template<typename OTHER_VALUE_TYPE>
+        bool Encapsulates(const TVector<OTHER_VALUE_TYPE, dimension>& value) const
+        {
+            return Encapsulates(vector_type(value));
+        }
 
         bool IsInitialized() const
         {
@@ -314,6 +656,11 @@ namespace Geometry
                 }
             case Type::Ball:
                 return 4 * Numerics::Constants::Pi * pow(ball.m_radius,3) / 3;
+            case Type::OrientedBox:
+                {
+                    const vector_type& h = orientedBox.m_halfExtents;
+                    return 8 * h[0] * h[1] * h[2];
+                }
             }
         }
 
@@ -328,6 +675,12 @@ namespace Geometry
             vector_type m_center;
             value_type m_radius;
         };
+        struct OrientedBox
+        {
+            vector_type m_center;
+            axes_type m_axes;
+            vector_type m_halfExtents;
+        };
 
         Type m_type;
         bool m_optimal;
@@ -335,8 +688,336 @@ namespace Geometry
         {
             Box box;
             Ball ball;
+            OrientedBox orientedBox;
         };
 
+        // number of elements if it can be determined without iterating
+        template<typename ITERATOR>
+        static size_t CountHint(ITERATOR itBegin, ITERATOR itEnd, std::random_access_iterator_tag)
+        {
+            return itEnd - itBegin;
+        }
+        template<typename ITERATOR, typename TAG>
+        static size_t CountHint(ITERATOR itBegin, ITERATOR itEnd, TAG)
+        {
+            return 0;
+        }
+
+        template<typename ITERATOR>
+        void SetApproximateBall(ITERATOR itBegin, ITERATOR itEnd)
+        {
+            // contiguous structure of arrays, so the distance loops can be vectorized; the extremal points along
+            // the axes are found while copying
+            std::array<std::vector<value_type>, dimension> coords;
+            std::array<size_t, 2 * dimension> extremes = {};
+            value_type vmin[dimension], vmax[dimension];
+            std::fill(vmin, vmin + dimension, Numerics::Limits<value_type>::MaxValue);
+            std::fill(vmax, vmax + dimension, Numerics::Limits<value_type>::MinValue);
+            const size_t expected = CountHint(itBegin, itEnd, typename std::iterator_traits<ITERATOR>::iterator_category());
+            for (auto& c : coords)
+            {
+                c.reserve(expected);
+            }
+            size_t count = 0;
+            for (ITERATOR it = itBegin; it != itEnd; ++it, ++count)
+            {
+                const auto& v = **it;
+                for (index_type j = 0; j < dimension; ++j)
+                {
+                    coords[j].push_back(v[j]);
+                    if (v[j] < vmin[j]) { vmin[j] = v[j]; extremes[2 * j] = count; }
+                    if (v[j] > vmax[j]) { vmax[j] = v[j]; extremes[2 * j + 1] = count; }
+                }
+            }
+            if (count == 0)
+            {
+                Clear();
+                return;
+            }
+
+            // initial ball on the most distant pair of extremal points
+            auto DistanceSquared = [&coords](const size_t i0, const size_t i1)
+            {
+                value_type d2 = 0;
+                for (index_type j = 0; j < dimension; ++j)
+                {
+                    const value_type d = coords[j][i0] - coords[j][i1];
+                    d2 += d * d;
+                }
+                return d2;
+            };
+            size_t i0 = extremes[0], i1 = extremes[1];
+            value_type max2 = DistanceSquared(i0, i1);
+            for (size_t a = 0; a < extremes.size(); ++a)
+            {
+                for (size_t b = a + 1; b < extremes.size(); ++b)
+                {
+                    const value_type d2 = DistanceSquared(extremes[a], extremes[b]);
+                    if (d2 > max2) { max2 = d2; i0 = extremes[a]; i1 = extremes[b]; }
+                }
+            }
+            value_type center[dimension];
+            for (index_type j = 0; j < dimension; ++j)
+            {
+                center[j] = (coords[j][i0] + coords[j][i1]) / 2;
+            }
+            value_type radius = sqrt(max2) / 2;
+            value_type radius2 = radius * radius;
+
+            // Ritter: grow the ball to include the points outside. Points are checked in blocks; the common case,
+            // a block which is completely inside, is a vectorizable maximum of distances.
+            const size_t blockSize = 64;
+            for (size_t begin = 0; begin < count; begin += blockSize)
+            {
+                const size_t end = std::min(count, begin + blockSize);
+                value_type blockMax2 = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    value_type d2 = 0;
+                    for (index_type j = 0; j < dimension; ++j)
+                    {
+                        const value_type d = coords[j][i] - center[j];
+                        d2 += d * d;
+                    }
+                    blockMax2 = std::max(blockMax2, d2);
+                }
+                if (blockMax2 <= radius2)
+                {
+                    continue;
+                }
+                for (size_t i = begin; i < end; ++i)
+                {
+                    value_type d2 = 0;
+                    for (index_type j = 0; j < dimension; ++j)
+                    {
+                        const value_type d = coords[j][i] - center[j];
+                        d2 += d * d;
+                    }
+                    if (d2 > radius2)
+                    {
+                        // new ball touches the far side of the old ball and the point
+                        const value_type d = sqrt(d2);
+                        const value_type newRadius = (radius + d) / 2;
+                        const value_type shift = (newRadius - radius) / d;
+                        for (index_type j = 0; j < dimension; ++j)
+                        {
+                            center[j] += (coords[j][i] - center[j]) * shift;
+                        }
+                        radius = newRadius;
+                        radius2 = radius * radius;
+                    }
+                }
+            }
+
+            // points on the surface can end up just outside due to rounding
+            radius += radius * 16 * std::numeric_limits<value_type>::epsilon();
+            vector_type c;
+            for (index_type j = 0; j < dimension; ++j)
+            {
+                c[j] = center[j];
+            }
+            Set(c, radius, false);
+        }
+
+        static axes_type IdentityAxes()
+        {
+            axes_type axes;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                axes[k].Fill(0);
+                axes[k][k] = 1;
+            }
+            return axes;
+        }
+
+        static OrientedBox ToOrientedBox(const Box& box)
+        {
+            OrientedBox res;
+            res.m_center = Middle(box.m_min, box.m_max);
+            res.m_axes = IdentityAxes();
+            res.m_halfExtents = (box.m_max - box.m_min) / 2;
+            return res;
+        }
+
+        // Eigenvectors (the columns of v) of the symmetric matrix a, cyclic Jacobi; a is diagonalized in place
+        static void Eigenvectors(value_type a[dimension][dimension], value_type v[dimension][dimension])
+        {
+            for (index_type i = 0; i < dimension; ++i)
+            {
+                for (index_type j = 0; j < dimension; ++j)
+                {
+                    v[i][j] = (i == j) ? 1 : 0;
+                }
+            }
+            for (int sweep = 0; sweep < 32; ++sweep)
+            {
+                value_type off = 0, diagonal = 0;
+                for (index_type p = 0; p < dimension; ++p)
+                {
+                    diagonal += a[p][p] * a[p][p];
+                    for (index_type q = p + 1; q < dimension; ++q)
+                    {
+                        off += a[p][q] * a[p][q];
+                    }
+                }
+                if (off <= diagonal * Numerics::Sqr(std::numeric_limits<value_type>::epsilon()))
+                {
+                    break;
+                }
+                for (index_type p = 0; p < dimension; ++p)
+                {
+                    for (index_type q = p + 1; q < dimension; ++q)
+                    {
+                        if (a[p][q] == 0)
+                        {
+                            continue;
+                        }
+                        // rotation in the p,q plane which zeroes a[p][q]
+                        const value_type theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                        const value_type t = (theta >= 0 ? 1 : -1) / (std::abs(theta) + sqrt(theta * theta + 1));
+                        const value_type c = 1 / sqrt(t * t + 1);
+                        const value_type s = t * c;
+                        for (index_type k = 0; k < dimension; ++k)
+                        {
+                            const value_type akp = a[k][p], akq = a[k][q];
+                            a[k][p] = c * akp - s * akq;
+                            a[k][q] = s * akp + c * akq;
+                        }
+                        for (index_type k = 0; k < dimension; ++k)
+                        {
+                            const value_type apk = a[p][k], aqk = a[q][k];
+                            a[p][k] = c * apk - s * aqk;
+                            a[q][k] = s * apk + c * aqk;
+                        }
+                        for (index_type k = 0; k < dimension; ++k)
+                        {
+                            const value_type vkp = v[k][p], vkq = v[k][q];
+                            v[k][p] = c * vkp - s * vkq;
+                            v[k][q] = s * vkp + c * vkq;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Box along the principal axes of the points (eigenvectors of their covariance), or the axis aligned box
+        // if that is smaller. Two passes over the points; not the minimal box, so never optimal.
+        template<typename ITERATOR>
+        void SetOrientedBox(ITERATOR itBegin, ITERATOR itEnd)
+        {
+            // first pass: covariance relative to the first point (limits cancellation) and the axis aligned box
+            vector_type origin, vmin, vmax;
+            value_type sum[dimension] = {};
+            value_type sum2[dimension][dimension] = {};
+            vmin.Fill(Numerics::Limits<value_type>::MaxValue);
+            vmax.Fill(Numerics::Limits<value_type>::MinValue);
+            size_t count = 0;
+            for (ITERATOR it = itBegin; it != itEnd; ++it, ++count)
+            {
+                const auto& v = **it;
+                if (count == 0)
+                {
+                    for (index_type i = 0; i < dimension; ++i)
+                    {
+                        origin[i] = v[i];
+                    }
+                }
+                value_type d[dimension];
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    d[i] = v[i] - origin[i];
+                    sum[i] += d[i];
+                    if (v[i] < vmin[i]) vmin[i] = v[i];
+                    if (v[i] > vmax[i]) vmax[i] = v[i];
+                }
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    for (index_type j = i; j < dimension; ++j)
+                    {
+                        sum2[i][j] += d[i] * d[j];
+                    }
+                }
+            }
+            if (count == 0)
+            {
+                Clear();
+                return;
+            }
+            value_type covariance[dimension][dimension], eigenvectors[dimension][dimension];
+            for (index_type i = 0; i < dimension; ++i)
+            {
+                for (index_type j = i; j < dimension; ++j)
+                {
+                    covariance[i][j] = covariance[j][i] = sum2[i][j] / count - (sum[i] / count) * (sum[j] / count);
+                }
+            }
+            Eigenvectors(covariance, eigenvectors);
+            axes_type axes;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    axes[k][i] = eigenvectors[i][k];
+                }
+                axes[k].Normalize();
+            }
+
+            // second pass: extent of the points along the axes
+            value_type pmin[dimension], pmax[dimension];
+            std::fill(pmin, pmin + dimension, Numerics::Limits<value_type>::MaxValue);
+            std::fill(pmax, pmax + dimension, Numerics::Limits<value_type>::MinValue);
+            for (ITERATOR it = itBegin; it != itEnd; ++it)
+            {
+                const auto& v = **it;
+                value_type d[dimension];
+                for (index_type i = 0; i < dimension; ++i)
+                {
+                    d[i] = v[i] - origin[i];
+                }
+                for (index_type k = 0; k < dimension; ++k)
+                {
+                    value_type p = 0;
+                    for (index_type i = 0; i < dimension; ++i)
+                    {
+                        p += d[i] * axes[k][i];
+                    }
+                    pmin[k] = std::min(pmin[k], p);
+                    pmax[k] = std::max(pmax[k], p);
+                }
+            }
+
+            vector_type center = origin, halfExtents;
+            value_type volume = 1, boxVolume = 1;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                center += axes[k] * ((pmin[k] + pmax[k]) / 2);
+                // points on the surface can end up just outside due to rounding
+                halfExtents[k] = (pmax[k] - pmin[k]) / 2 * (1 + 16 * std::numeric_limits<value_type>::epsilon());
+                volume *= pmax[k] - pmin[k];
+                boxVolume *= vmax[k] - vmin[k];
+            }
+            if (boxVolume <= volume)
+            {
+                OrientedBox res = ToOrientedBox(Box{ vmin, vmax });
+                Set(res.m_center, res.m_axes, res.m_halfExtents, false);
+            }
+            else
+            {
+                Set(center, axes, halfExtents, false);
+            }
+        }
+
+        static bool Encapsulates(const OrientedBox& box, const vector_type& value)
+        {
+            const vector_type d = value - box.m_center;
+            bool res = true;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                res = res && std::abs(d.InnerProduct(box.m_axes[k])) <= box.m_halfExtents[k];
+            }
+            return res;
+        }
+
         static bool Encapsulates(const Box& box, const vector_type& value)
         {
             bool res = true;
@@ -410,6 +1091,69 @@ namespace Geometry
             return TouchesCoord<0>(box,ball,corner,contained);
         }
 
+        // distance from the ball center to the closest point of the box, in box coordinates
+        static bool Touches(const OrientedBox &box, const Ball &ball)
+        {
+            const vector_type d = ball.m_center - box.m_center;
+            value_type distance2 = 0;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                const value_type outside = std::abs(d.InnerProduct(box.m_axes[k])) - box.m_halfExtents[k];
+                if (outside > 0)
+                {
+                    distance2 += outside * outside;
+                }
+            }
+            return distance2 <= ball.m_radius * ball.m_radius;
+        }
+
+        // true if the projections of the boxes on axis don't overlap
+        static bool Separates(const OrientedBox &b0, const OrientedBox &b1, const vector_type& d, const vector_type& axis)
+        {
+            value_type r = 0;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                r += b0.m_halfExtents[k] * std::abs(b0.m_axes[k].InnerProduct(axis));
+                r += b1.m_halfExtents[k] * std::abs(b1.m_axes[k].InnerProduct(axis));
+            }
+            return std::abs(d.InnerProduct(axis)) > r;
+        }
+
+        // in 3d, the cross products of the edge directions are candidate separating axes too
+        static bool SeparatedByEdgeAxes(const OrientedBox &b0, const OrientedBox &b1, const vector_type& d, std::true_type)
+        {
+            for (index_type i = 0; i < dimension; ++i)
+            {
+                for (index_type j = 0; j < dimension; ++j)
+                {
+                    const vector_type axis = CrossProduct(b0.m_axes[i], b1.m_axes[j]);
+                    // (nearly) parallel edges are covered by the face axes
+                    if (axis.LengthSquared() > 1e-12 && Separates(b0, b1, d, axis))
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        static bool SeparatedByEdgeAxes(const OrientedBox &b0, const OrientedBox &b1, const vector_type& d, std::false_type)
+        {
+            return false;
+        }
+
+        static bool Touches(const OrientedBox &b0, const OrientedBox &b1)
+        {
+            const vector_type d = b1.m_center - b0.m_center;
+            for (index_type k = 0; k < dimension; ++k)
+            {
+                if (Separates(b0, b1, d, b0.m_axes[k]) || Separates(b0, b1, d, b1.m_axes[k]))
+                {
+                    return false;
+                }
+            }
+            return !SeparatedByEdgeAxes(b0, b1, d, std::integral_constant<bool, dimension == 3>());
+        }
+
     };
 
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+namespace Geometry
+{
+    /* BoundingShapeBatch : many bounding shapes, tested against one query at once (broad phase, culling)
+     *
+     * Every bounding shape is stored as a box with a radius around it (structure of arrays): a Ball is a point
+     * box with its radius, a Box has radius 0. Two of these touch if the distance between their boxes is at
+     * most the sum of their radii, which is exact for every combination of balls and boxes and can be
+     * evaluated for 4 (AVX, when the library is compiled with it) or 2 (SSE2) bounding shapes per instruction
+     * without branches. An OrientedBox (stored or queried) is tested on its enclosing box first, candidates are then
+     * tested exactly with BoundingShape3d::Touches. Uninitialized bounding shapes never touch anything.
+     *
+     * Results are either the indices of the touching bounding shapes, in increasing order, or a bit mask with
+     * bit i % 64 of word i / 64 set for bounding shape i.
+     */
+    class BoundingShapeBatch
+    {
+    public:
+        typedef uint32_t index_type;
+
+        BoundingShapeBatch();
+
+        void Clear();
+        void Reserve(const size_t count);
+        size_t GetSize() const { return m_size; }
+
+        // returns the index of the new bounding shape
+        index_type Add(const BoundingShape3d& boundingShape);
+        void Set(const index_type index, const BoundingShape3d& boundingShape);
+
+        void Touches(const BoundingShape3d& query, std::vector<uint64_t>& mask) const;
+        void Touches(const BoundingShape3d& query, std::vector<index_type>& indices) const;
+        void Encapsulates(const Vector3d& point, std::vector<index_type>& indices) const;
+
+        // convert a mask to the indices of its set bits
+        static void GetIndices(const std::vector<uint64_t>& mask, std::vector<index_type>& indices);
+
+    private:
+        // a padded block of entries produces one word of the mask
+        static const size_t BlockSize = 64;
+
+        size_t m_size;
+        std::vector<double> m_min[3];
+        std::vector<double> m_max[3];
+        std::vector<double> m_radius;
+        // the exact oriented boxes, by index
+        std::vector<std::pair<index_type, BoundingShape3d>> m_orientedBoxes;
+
+        void SetEntry(const size_t index, const BoundingShape3d& boundingShape);
+        void Touches(const double min[3], const double max[3], const double radius, std::vector<uint64_t>& mask) const;
+    };
+}
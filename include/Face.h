@@ -14,12 +14,14 @@ namespace Geometry
         container_type m_edges;
         NormalPtr m_normal;
         ColorPtr m_color;
+        bool m_normalOutdated;
 
     protected:
         Face(const HullRaw& hull)
             : m_edges()
             , m_normal()
             , m_hull(hull)
+            , m_normalOutdated(true)
         {}
         Face(const this_type &other) = default;
         Face(this_type &&other) = default;
@@ -30,9 +32,10 @@ namespace Geometry
 
         ~Face();
 
-        const EdgePtr& AddEdge(EdgePtr& edge) { return *m_edges.emplace(edge).first; }
+        // changing the edges of a face materializes the hull first (see Hull::Materialize)
+        const EdgePtr& AddEdge(EdgePtr& edge);
         const EdgePtr& AddEdge(EdgeRaw& edge) { return AddEdge(edge.lock()); }
-        void RemoveEdge(EdgePtr& edge) { m_edges.erase(edge); }
+        void RemoveEdge(EdgePtr& edge);
         void RemoveEdge(EdgeRaw& edge) { RemoveEdge(edge.lock()); }
         template<typename... Args>
         const EdgePtr& ConstructAndAddEdge(Args&&... args)
@@ -42,8 +45,16 @@ namespace Geometry
         }
 
         const NormalPtr& GetNormal() const { return m_normal; }
-        void SetNormal(const NormalPtr& normal) { m_normal = normal; }
+        void SetNormal(const NormalPtr& normal) { m_normal = normal; m_normalOutdated = !normal; }
+        // calculate and store the normal of the edge ring
         void CalcNormal();
+        // the normal of the edge ring, without storing it
+        Normal CalculateNormal() const;
+        // store the value of the normal; the normal object is reused when this face is its only owner
+        void UpdateNormal(const Normal& normal);
+        // new faces have an outdated normal until it is calculated or set, see Hull::UpdateNormals
+        bool IsNormalOutdated() const { return m_normalOutdated; }
+        void InvalidateNormal() { m_normalOutdated = true; }
 
         const EdgePtr& GetStartEdge() const { return *m_edges.begin(); }
         const container_type& GetEdgesUnordered() const { return m_edges; }
@@ -53,6 +64,7 @@ namespace Geometry
         void SetColor(const ColorPtr& color) { m_color = color; }
 
         const HullRaw& GetHull() const { return m_hull; }
+        void SetHull(const HullRaw& hull) { m_hull = hull; }
 
         size_t GetEdgeCount() const { return m_edges.size(); }
 
@@ -2,7 +2,10 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <iostream>
@@ -12,6 +15,7 @@
 #include <mutex>
 #include <random>
 #include <stack>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -21,6 +25,7 @@
 #include "boost/format.hpp"
 
 #include "SmallObjectAllocator.h"
+#include "Profiling.h"
 
 #include "Aliases.h"
 
@@ -32,10 +37,13 @@
 #include "MiniBall.h"
 
 #include "Vector.h"
+#include "PackedNormal.h"
+#include "VectorBatch.h"
 #include "Line.h"
 #include "RGBColor.h"
 #include "RGBAColor.h"
 #include "BoundingShape.h"
+#include "BoundingShapeBatch.h"
 #include "Contour.h"
 #include "Quaternion.h"
 #include "RotationMatrix.h"
@@ -44,6 +52,9 @@
 #include "Face.h"
 #include "Hull.h"
 #include "Shape.h"
+#include "ShapeFormat.h"
+#include "MappedShape.h"
+#include "ShapeLibrary.h"
 #include "Dodecahedron.h"
 #include "Cube.h"
 
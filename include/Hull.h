@@ -10,22 +10,102 @@ namespace Geometry
         typedef std::unordered_set<FacePtr> container_type;
         typedef Hull this_type;
         typedef unsigned int size_type;
+        // Fills an empty shape with the hull geometry, see SetLoader
+        typedef std::function<void(Shape& shape)> Loader;
 
         enum class Orientation : unsigned char
         {
             Outward = 0,
             Inward = 1
         };
+
+        /* InstanceTransform : maps the (shared) geometry of a hull into shape coordinates
+         *
+         *   v' = rotation(v * scale) + translation
+         */
+        class InstanceTransform
+        {
+        public:
+            InstanceTransform()
+                : m_scale(1)
+                , m_rotation()
+                , m_translation(0, 0, 0)
+            {}
+
+            double GetScale() const { return m_scale; }
+            const Quat& GetRotation() const { return m_rotation; }
+            const Vector3d& GetTranslation() const { return m_translation; }
+
+            bool IsIdentity() const { return m_scale == 1 && m_rotation == Quat() && m_translation == Vector3d(0, 0, 0); }
+
+            // append a transformation (applied after the current one)
+            void Scale(const double factor) { m_scale *= factor; m_translation *= factor; }
+            void Rotate(const Quat& rotation) { m_rotation = rotation * m_rotation; m_translation = rotation.Transform(m_translation); }
+            void Translate(const Vector3d& translation) { m_translation += translation; }
+
+        private:
+            double m_scale;
+            Quat m_rotation;
+            Vector3d m_translation;
+        };
+
+        /* ValidationReport : result of Validate; counts of the faces and edges with a problem
+         *
+         * The checksum is an order independent hash of the vertex positions along the edge rings, it only
+         * depends on the geometry and the topology (not on the memory layout), so it survives Store/Retrieve.
+         */
+        struct ValidationReport
+        {
+            size_t m_faces;
+            size_t m_edges;
+            size_t m_degenerateFaces;       // faces with less than 3 edges
+            size_t m_openRings;             // faces whose edge ring doesn't close, or with next/prev links which don't match
+            size_t m_foreignEdges;          // edges in a ring which aren't owned by the face or refer to another face
+            size_t m_foreignFaces;          // faces which refer to another hull
+            size_t m_unpairedTwins;         // edges without a twin, or whose twin doesn't refer back
+            size_t m_nonManifoldEdges;      // twins which don't run in opposite direction, or which lie in the same face
+            size_t m_inconsistentNormals;   // faces with only some edge normals, or a normal opposite to the edge ring
+            uint64_t m_checksum;
+
+            bool IsValid() const
+            {
+                return 0 == m_degenerateFaces + m_openRings + m_foreignEdges + m_foreignFaces + m_unpairedTwins + m_nonManifoldEdges + m_inconsistentNormals;
+            }
+            void Merge(const ValidationReport& other);
+            // one line summary of the problems
+            std::string ToString() const;
+            // throws std::runtime_error(what + summary) when not valid
+            void Check(const std::string& what) const;
+        };
+
     private:
         ShapeRaw m_shape;
         Orientation m_orientation;
         container_type m_faces;
         BoundingShape3d m_boundingShape;
 
+        // the hull whose faces are shared (instanced hulls only, see GetGeometry), and the instances sharing the faces of this hull
+        HullPtr m_geometry;
+        InstanceTransform m_transform;
+        std::vector<std::weak_ptr<Hull>> m_instances;
+        std::atomic<bool> m_hasInstances;
+        std::mutex m_instancesMutex;
+        std::mutex m_materializeMutex;
+
         ColorPtr m_color;
         RenderMode m_renderMode;
         std::shared_ptr<IRenderObject> m_renderObject;
 
+        // modification tracking, see GetGeneration
+        uint64_t m_generation;
+        uint64_t m_storedGeneration;
+        int64_t m_storeId;
+
+        // geometry which is loaded on first access, see SetLoader
+        Loader m_loader;
+        std::atomic<bool> m_loadPending;
+        std::mutex m_loadMutex;
+
         std::mutex m_mutex;
 
     protected:
@@ -36,9 +116,18 @@ namespace Geometry
             : m_shape(shape)
             , m_orientation(Orientation::Outward)
             , m_boundingShape()
+            , m_geometry()
+            , m_transform()
+            , m_instances()
+            , m_hasInstances(false)
             , m_color(nullptr)
             , m_renderMode(RenderMode::Solid)
             , m_renderObject(std::make_unique<NOPRenderObject>())
+            , m_generation(0)
+            , m_storedGeneration(0)
+            , m_storeId(0)
+            , m_loader()
+            , m_loadPending(false)
         {}
 
         // shallow copy only!
@@ -56,25 +145,62 @@ namespace Geometry
         // copies the hull into newShape
         HullPtr Hull::Copy(Shape& newShape) const;
 
-        const FacePtr& AddFace(const FacePtr& face) { return *m_faces.emplace(face).first; }
+        // creates an instance of the hull in newShape; it shares the faces of this hull, which keeps owning them,
+        // until one of both hulls modifies them.
+        HullPtr Instance(Shape& newShape);
+
+        // Instanced hulls expose the shared geometry (faces, edges and vertices in geometry coordinates)
+        // through GetFaces() and the ForEach* functions; the instance transform maps it into shape coordinates.
+        // The shared faces belong to the original hull: changing them (through Face/Edge functions which modify
+        // the edge containers of a face) changes the original, after its instances got their private copies.
+        // Changing the topology or the vertices through an instance gives it a private copy first. Call
+        // Materialize() on a hull before modifying its edges or vertices directly.
+        // An instance may be materialized by a modification of its original, from the thread which does so; for
+        // thread safety, an original and its instances count as one object.
+        bool IsInstance() const { return nullptr != GetGeometry(); }
+        const InstanceTransform& GetInstanceTransform() const { return m_transform; }
+        void Materialize();
+
+        const FacePtr& AddFace(const FacePtr& face) { Materialize(); MarkModified(); return *m_faces.emplace(face).first; }
         const FacePtr& AddFace(const FaceRaw& face) { return AddFace(face.lock()); }
-        void RemoveFace(const FacePtr& face) { m_faces.erase(face); }
+        // a face of the shared geometry removes its private copy from an instance
+        void RemoveFace(const FacePtr& face);
         void RemoveFace(const FaceRaw& face) { RemoveFace(face.lock()); }
         template<typename... Args>
         const FacePtr& ConstructAndAddFace(Args&& ... args)
         {
+            Materialize();
             FacePtr face = Construct<Face>(this, std::forward<Args>(args)...);
             return AddFace(face);
         }
 
         // Return the hull orientation
         Orientation GetOrientation() const { return m_orientation; }
-        void SetOrientation(const Orientation& orientation) { m_orientation = orientation; }
+        void SetOrientation(const Orientation& orientation) { m_orientation = orientation; MarkModified(); }
 
-        // Invalidate makes cached render state in render object invalid.
-        void Invalidate() { m_renderObject->Invalidate(); }
+        // Invalidate makes cached render state in render object invalid, and marks the hull as modified.
+        void Invalidate() { MarkModified(); m_renderObject->Invalidate(); }
         void ForcedInvalidate() { m_renderObject->ForcedInvalidate(); }
 
+        // Modification tracking for incremental stores (Shape::StorageMode::Delta). Every change made through the
+        // hull (color, render mode, orientation, transformations, faces) increases the generation; call Invalidate()
+        // after changing faces, edges or vertices directly. The store id is the row of the hull in the db it was
+        // last stored in or retrieved from (0: none).
+        uint64_t GetGeneration() const { return m_generation; }
+        void MarkModified() { ++m_generation; }
+        int64_t GetStoreId() const { return m_storeId; }
+        bool IsModifiedSinceStore() const { return 0 == m_storeId || m_generation != m_storedGeneration; }
+        void SetStored(const int64_t storeId) { m_storeId = storeId; m_storedGeneration = m_generation; }
+
+        // Lazy loading: the faces of a hull with a loader are created by the loader on first access to the
+        // geometry (GetFaces, the ForEach* functions and everything using them), from whichever thread comes
+        // first. The loader fills an empty shape with a single hull whose faces are taken over; orientation, color
+        // and bounding shape are set on the hull up front. Loading doesn't count as a modification.
+        // Load() throws whatever the loader throws, the hull stays unloaded in that case.
+        void SetLoader(const Loader& loader);
+        bool IsLoaded() const { return !m_loadPending; }
+        void Load() const { if (m_loadPending) const_cast<Hull*>(this)->LoadNow(); }
+
         // RenderObject is a device dependent object state (for instance OpenGL displaylists).
         std::shared_ptr<IRenderObject> GetRenderObject() const { return m_renderObject; }
         void SetRenderObject(const std::shared_ptr<IRenderObject>& renderObject) { m_renderObject = renderObject; }
@@ -89,15 +215,20 @@ namespace Geometry
 
         // get/set/calculate/use the bounding shape
         const BoundingShape3d& GetBoundingShape() const { return m_boundingShape; }
-        void SetBoundingShape(const BoundingShape3d& boundingShape) { m_boundingShape = boundingShape; /*Invalidate();*/ }
-        void CalculateBoundingShape(const BoundingShape3d::Type type = BoundingShape3d::Type::Ball);
+        void SetBoundingShape(const BoundingShape3d& boundingShape) { m_boundingShape = boundingShape; MarkModified(); /*Invalidate();*/ }
+        // an approximate ball is cheaper, but not optimal (see BoundingShape3d::Accuracy)
+        void CalculateBoundingShape(const BoundingShape3d::Type type = BoundingShape3d::Type::Ball, const BoundingShape3d::Accuracy accuracy = BoundingShape3d::Accuracy::Exact);
         bool BoundingShapesTouch(const this_type &other) const { return m_boundingShape.Touches(other.GetBoundingShape()); }
 
+        // Check the integrity of the half edge structure in a single (parallel) pass over the faces; cheap enough
+        // to run on every load. The geometry is that of GetFaces(), instanced hulls check their shared geometry.
+        ValidationReport Validate() const;
+
         // calculate the volume of the hull
         double CalculateVolume() const;
 
         // direct access to contained faces/edges
-        const container_type& GetFaces() const { return m_faces; }
+        const container_type& GetFaces() const { Load(); const HullPtr geometry = GetGeometry(); return geometry ? geometry->m_faces : m_faces; }
         std::unordered_set<VertexRaw> GetVertices() const;
 
         // access to the parent shape
@@ -108,18 +239,38 @@ namespace Geometry
         void ForEachEdge(std::function<void(const EdgeRaw& edgePtr)> func) const;
         void ForEachVertex(std::function<void(const VertexRaw& vertexPtr)> func) const;
 
+        // Transformations; the bounding shape is transformed along (see BoundingShape3d::Scale), it isn't recalculated
+
         // scale every vertex
         void Scale(const double factor);
 
         // translate every vertex
         void Translate(const Vector3d& translation);
 
+        // rotate every vertex and normal
+        void Rotate(const Quat& rotation);
+
         // Split every edge in the hull; every triangle becomes 4 triangles
         void SplitTrianglesIn4();
 
         // Make sure the hull exist solely out of triangles
         void Triangulate();
 
+        // Normals. UpdateNormals calculates the normals of the faces with an outdated normal (new faces, see
+        // Face::IsNormalOutdated) in parallel and stores them in the existing normal objects where possible.
+        // InvalidateNormals outdates every face; call it after moving vertices directly. With vertex normals, each
+        // vertex of those faces (and of faces with missing edge normals) gets one normal, shared by the edges
+        // starting at it: the average of the normals of the faces around it, weighted by the angle or the area of
+        // their corner at the vertex.
+        enum class VertexNormals : unsigned char
+        {
+            None = 0,           // leave the edge normals alone
+            AngleWeighted = 1,
+            AreaWeighted = 2
+        };
+        void UpdateNormals(const VertexNormals vertexNormals = VertexNormals::None);
+        void InvalidateNormals();
+
         // geometry operations
         HullPtr Add(HullPtr& other);       // A joined with B, returns new hull or null if there is no overlap.
         std::vector<HullPtr> Subtract(HullPtr& other);  // A minus overlap with B, returns all resulting pieces (A and B if there is no overlap).
@@ -139,6 +290,22 @@ namespace Geometry
             return std::unique_lock<std::mutex>(m_mutex,std::try_to_lock);
         }
 
+    private:
+        // run the loader and take over the faces it created
+        void LoadNow();
+        // m_geometry may be reset by another thread, see MaterializeFrom
+        HullPtr GetGeometry() const { return std::atomic_load(&m_geometry); }
+        // give the instances sharing the faces of this hull a private copy of them
+        void DetachInstances();
+        // stop sharing the faces of shared (of any hull if null); returns the private copy of each shared face,
+        // empty if there were none or if the faces were taken over
+        std::unordered_map<FaceRaw, FacePtr> MaterializeFrom(const Hull* shared);
+        // deep copy the faces of other into this hull; returns the copy of each face of other
+        std::unordered_map<FaceRaw, FacePtr> CopyFaces(const Hull& other);
+        // apply a transformation to all vertices and normals; returns the largest distance a vertex moved by rounding
+        // it to the precision of Vertex (0 unless GEOMETRY_SINGLE_PRECISION)
+        double ApplyTransform(const InstanceTransform& transform);
+
     };
 }
 
@@ -0,0 +1,147 @@
+#pragma once
+
+namespace Geometry
+{
+    /* MappedShape : read-only view on a binary shape file (see ShapeFormat.h and Shape::Save)
+     *
+     * The file is mapped into memory and used in place; opening a shape makes one pass over the edges, faces
+     * and hulls to check their indices, the vertex data is only read from disk when it is touched. Vertices,
+     * normals and texture coordinates are handed out as pointers into the mapping, bounding shapes come
+     * straight from the hull headers. The mapping is private: writes through the returned pointers never
+     * reach the file.
+     *
+     * Edges, faces and hulls are exposed as light weight views (EdgeView, FaceView, HullView) since the
+     * Edge/Face/Hull classes own their data. Use Materialize() to obtain a modifiable Shape.
+     */
+    class MappedShape
+    {
+    public:
+        typedef MappedShape this_type;
+        typedef uint32_t index_type;
+
+        class FaceView;
+        class HullView;
+
+        class EdgeView
+        {
+        public:
+            EdgeView(const MappedShape& shape, const index_type index)
+                : m_shape(&shape)
+                , m_index(index)
+            {}
+
+            index_type GetIndex() const { return m_index; }
+            bool operator == (const EdgeView& other) const { return m_index == other.m_index && m_shape == other.m_shape; }
+            bool operator != (const EdgeView& other) const { return !(*this == other); }
+
+            VertexRaw GetStartVertex() const { return m_shape->GetVertex(Packed().m_vertex); }
+            NormalRaw GetStartNormal() const { return m_shape->GetNormal(Packed().m_normal); }
+            TextureCoordRaw GetStartTextureCoord() const { return m_shape->GetTextureCoord(Packed().m_textureCoord); }
+            ColorPtr GetStartColor() const { return m_shape->GetColor(Packed().m_color); }
+
+            EdgeView GetTwin() const { return EdgeView(*m_shape, Packed().m_twin); }
+            EdgeView GetNext() const { return EdgeView(*m_shape, Packed().m_next); }
+            EdgeView GetPrev() const { return EdgeView(*m_shape, Packed().m_prev); }
+            FaceView GetFace() const;
+        private:
+            const ShapeFormat::PackedEdge& Packed() const { return m_shape->m_view.m_edges[m_index]; }
+
+            const MappedShape* m_shape;
+            index_type m_index;
+        };
+
+        class FaceView
+        {
+        public:
+            FaceView(const MappedShape& shape, const index_type index)
+                : m_shape(&shape)
+                , m_index(index)
+            {}
+
+            index_type GetIndex() const { return m_index; }
+
+            NormalRaw GetNormal() const { return m_shape->GetNormal(Packed().m_normal); }
+            ColorPtr GetColor() const { return m_shape->GetColor(Packed().m_color); }
+
+            size_t GetEdgeCount() const { return Packed().m_edgeCount; }
+            EdgeView GetStartEdge() const { return EdgeView(*m_shape, Packed().m_firstEdge); }
+
+            void ForEachEdge(std::function<void(const EdgeView& edge)> func) const;
+            void ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const;
+        private:
+            const ShapeFormat::PackedFace& Packed() const { return m_shape->m_view.m_faces[m_index]; }
+
+            const MappedShape* m_shape;
+            index_type m_index;
+        };
+
+        class HullView
+        {
+        public:
+            HullView(const MappedShape& shape, const index_type index)
+                : m_shape(&shape)
+                , m_index(index)
+            {}
+
+            index_type GetIndex() const { return m_index; }
+
+            Hull::Orientation GetOrientation() const { return Packed().m_orientation == 1 ? Hull::Orientation::Inward : Hull::Orientation::Outward; }
+            ColorPtr GetColor() const { return m_shape->GetColor(Packed().m_color); }
+            BoundingShape3d GetBoundingShape() const { return ShapeFormat::Unpack(Packed().m_boundingShape); }
+
+            size_t GetFaceCount() const { return Packed().m_faceCount; }
+
+            void ForEachFace(std::function<void(const FaceView& face)> func) const;
+            void ForEachEdge(std::function<void(const EdgeView& edge)> func) const;
+            // every vertex of the hull once
+            void ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const;
+        private:
+            const ShapeFormat::PackedHull& Packed() const { return m_shape->m_view.m_hulls[m_index]; }
+
+            const MappedShape* m_shape;
+            index_type m_index;
+        };
+
+        MappedShape();
+        MappedShape(const std::string& fileName);
+        MappedShape(const this_type& other) = delete;
+        MappedShape(this_type&& other) = delete;
+        ~MappedShape();
+
+        MappedShape& operator = (const this_type& other) = delete;
+        MappedShape& operator = (this_type&& other) = delete;
+
+        // Map a shape file; throws std::runtime_error if the file can not be mapped, is not a shape file or refers
+        // to edges, faces or hulls which are not in it.
+        void Open(const std::string& fileName);
+        void Close();
+        bool IsOpen() const;
+
+        BoundingShape3d GetBoundingShape() const { return ShapeFormat::Unpack(m_view.m_header.m_boundingShape); }
+
+        size_t GetHullCount() const { return (size_t)m_view.m_header.m_hulls.m_count; }
+        size_t GetFaceCount() const { return (size_t)m_view.m_header.m_faces.m_count; }
+        size_t GetEdgeCount() const { return (size_t)m_view.m_header.m_edges.m_count; }
+        size_t GetVertexCount() const { return (size_t)m_view.m_header.m_vertices.m_count; }
+        HullView GetHull(const index_type index) const { return HullView(*this, index); }
+
+        // perform function on each object, same as the Shape::ForEach* functions
+        void ForEachHull(std::function<void(const HullView& hull)> func) const;
+        void ForEachFace(std::function<void(const FaceView& face)> func) const;
+        void ForEachEdge(std::function<void(const EdgeView& edge)> func) const;
+        void ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const;
+
+        // Create a normal (modifiable) shape from the mapped data
+        ShapePtr Materialize() const;
+
+    private:
+        VertexRaw GetVertex(const index_type index) const;
+        NormalRaw GetNormal(const index_type index) const;
+        TextureCoordRaw GetTextureCoord(const index_type index) const;
+        ColorPtr GetColor(const index_type index) const;
+
+        class State;
+        std::unique_ptr<State> m_state;
+        ShapeFormat::View m_view;
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+namespace Geometry
+{
+    /* PackedNormal : compact encodings of unit normals, e.g. for large display only meshes or vertex buffers
+     *
+     *   Octahedral   2 x 16 bit, the sphere is folded onto the octahedron |x|+|y|+|z|=1 and flattened to a
+     *                square; the error is below 1e-4 radians.
+     *   1010102      3 x 10 bit signed coordinates, the layout of GL_INT_2_10_10_10_REV (x in the lowest
+     *                bits, the 2 bit w is 0); the error is below 4e-3 radians.
+     *
+     * Decoded normals have length 1. The normal to encode has to have length 1 as well (1010102) or at least
+     * be non zero (Octahedral).
+     */
+    namespace PackedNormal
+    {
+        namespace Internal
+        {
+            inline double Sign(const double value)
+            {
+                return value < 0 ? -1.0 : 1.0;
+            }
+
+            // [-1,1] <-> signed integer of the given number of bits
+            inline int32_t ToSnorm(const double value, const int bits)
+            {
+                const double scale = (double)((1 << (bits - 1)) - 1);
+                return (int32_t)std::lround(Numerics::Clamp(value, -1.0, 1.0) * scale);
+            }
+            inline double FromSnorm(const int32_t value, const int bits)
+            {
+                const double scale = (double)((1 << (bits - 1)) - 1);
+                return std::max(-1.0, value / scale);
+            }
+
+            // lower half of the octahedron folded over the upper half
+            inline void Fold(double& u, double& v)
+            {
+                const double foldedU = (1 - std::abs(v)) * Sign(u);
+                const double foldedV = (1 - std::abs(u)) * Sign(v);
+                u = foldedU;
+                v = foldedV;
+            }
+
+            inline Normal Normalized(const double x, const double y, const double z)
+            {
+                const double length = std::sqrt(x * x + y * y + z * z);
+                return Normal((Normal::value_type)(x / length), (Normal::value_type)(y / length), (Normal::value_type)(z / length));
+            }
+        }
+
+        inline uint32_t EncodeOctahedral(const Normal& normal)
+        {
+            const double l1 = std::abs((double)normal[0]) + std::abs((double)normal[1]) + std::abs((double)normal[2]);
+            double u = normal[0] / l1;
+            double v = normal[1] / l1;
+            if (normal[2] < 0)
+            {
+                Internal::Fold(u, v);
+            }
+            return (uint32_t)(uint16_t)Internal::ToSnorm(u, 16) | ((uint32_t)(uint16_t)Internal::ToSnorm(v, 16) << 16);
+        }
+
+        inline Normal DecodeOctahedral(const uint32_t packed)
+        {
+            double u = Internal::FromSnorm((int16_t)(packed & 0xFFFF), 16);
+            double v = Internal::FromSnorm((int16_t)(packed >> 16), 16);
+            const double z = 1 - std::abs(u) - std::abs(v);
+            if (z < 0)
+            {
+                Internal::Fold(u, v);
+            }
+            return Internal::Normalized(u, v, z);
+        }
+
+        inline uint32_t Encode1010102(const Normal& normal)
+        {
+            uint32_t packed = 0;
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                packed |= ((uint32_t)Internal::ToSnorm(normal[i], 10) & 0x3FF) << (10 * i);
+            }
+            return packed;
+        }
+
+        inline Normal Decode1010102(const uint32_t packed)
+        {
+            double coords[3];
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                // sign extend the 10 bit value
+                const int32_t value = (int32_t)(((packed >> (10 * i)) & 0x3FF) << 22) >> 22;
+                coords[i] = Internal::FromSnorm(value, 10);
+            }
+            return Internal::Normalized(coords[0], coords[1], coords[2]);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+namespace Geometry
+{
+    /* Profiling : scoped timers for the expensive operations of the library
+     *
+     * Define GEOMETRY_PROFILING (in the project settings) to record every GEOMETRY_PROFILE_SCOPE: name, thread,
+     * start, duration and the number of elements (faces, hulls, ...) processed. Without it the macros expand to
+     * nothing, including the arguments of GEOMETRY_PROFILE_ELEMENTS.
+     *
+     * Every thread appends to a buffer of its own; the buffers are only shared when reading them.
+     * The recorded events can be summarized per name (GetStatistics) or written as a Chrome trace
+     * (load the file in chrome://tracing or https://ui.perfetto.dev).
+     */
+    namespace Profiling
+    {
+        struct Event
+        {
+            const char* m_name;     // static string
+            int64_t m_start;        // ns since the first event
+            int64_t m_duration;     // ns
+            uint64_t m_elements;
+            unsigned int m_thread;  // 0, 1, ... in order of the first event on the thread
+        };
+
+        struct Statistics
+        {
+            uint64_t m_calls;
+            double m_totalMs;
+            double m_maxMs;
+            uint64_t m_elements;
+        };
+
+        // ns since the first call
+        int64_t Now();
+        // add an event to the buffer of the calling thread
+        void Record(const char* name, const int64_t start, const int64_t duration, const uint64_t elements);
+
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(const char* name)
+                : m_name(name)
+                , m_elements(0)
+                , m_start(Now())
+            {}
+            ~ScopedTimer()
+            {
+                Record(m_name, m_start, Now() - m_start, m_elements);
+            }
+            ScopedTimer(const ScopedTimer& other) = delete;
+            ScopedTimer& operator = (const ScopedTimer& other) = delete;
+
+            void AddElements(const uint64_t elements) { m_elements += elements; }
+        private:
+            const char* m_name;
+            uint64_t m_elements;
+            int64_t m_start;
+        };
+
+        // events of all threads, ordered by start
+        std::vector<Event> GetEvents();
+        // per event name
+        std::map<std::string, Statistics> GetStatistics();
+        // discard all events
+        void Reset();
+
+        // Chrome trace event format (JSON); the file version throws std::runtime_error if the file can't be written
+        void WriteChromeTrace(std::ostream& stream);
+        void WriteChromeTrace(const std::string& fileName);
+    }
+}
+
+#ifdef GEOMETRY_PROFILING
+#define GEOMETRY_PROFILE_SCOPE(name) Geometry::Profiling::ScopedTimer geometryProfileScope(name)
+#define GEOMETRY_PROFILE_ELEMENTS(count) geometryProfileScope.AddElements(count)
+#else
+#define GEOMETRY_PROFILE_SCOPE(name)
+#define GEOMETRY_PROFILE_ELEMENTS(count)
+#endif
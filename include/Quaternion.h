@@ -264,19 +264,44 @@ namespace Geometry
             auto res = Inverted() * this_type(0, v[0], v[1], v[2]) * *this;
             return vector_type(res.GetX(), res.GetY(), res.GetZ());
         }
+
+        // result[i] = Transform(vectors[i]), result can be vectors; the quaternion is converted to a rotation matrix once
+        void Transform(const vector_type* vectors, const size_t count, vector_type* result) const
+        {
+            TRotationMatrix3<value_type>(*this).Transform(vectors, count, result);
+        }
+        void InverseTransform(const vector_type* vectors, const size_t count, vector_type* result) const
+        {
+            TRotationMatrix3<value_type>(Inverted()).Transform(vectors, count, result);
+        }
     };
 
+    namespace Internal
+    {
+        // make the start/end of an interpolation smooth (acceleration)
+        template<typename VALUE_TYPE>
+        VALUE_TYPE SmoothInterpolation(const VALUE_TYPE t)
+        {
+            return (VALUE_TYPE)(0.5*(1 - cos(t*Numerics::Constants::Pi)));
+        }
+    }
+
+    // spherical interpolation between unit quaternions q0 (t<=0) and q1 (t>=1), along the shortest path
     template<typename VALUE_TYPE>
-    TQuaternion<VALUE_TYPE> Slerp(TQuaternion<VALUE_TYPE> const &q0, TQuaternion<VALUE_TYPE> &q1, VALUE_TYPE t)
+    TQuaternion<VALUE_TYPE> Slerp(TQuaternion<VALUE_TYPE> const &q0, TQuaternion<VALUE_TYPE> const &end, VALUE_TYPE t)
     {
         // Already completely rotated?
         if (t >= 1)
         {
-            return q1;
+            return end;
         }
-        // make the start/end smooth (acceleration)
-        t = 0.5*(1 - cos(t*Common::Pi));
+        if (t <= 0)
+        {
+            return q0;
+        }
+        t = Internal::SmoothInterpolation(t);
         // Calculate angle between them.
+        TQuaternion<VALUE_TYPE> q1 = end;
         VALUE_TYPE cosHalfTheta = q0.InnerProduct(q1);
         // if q0=q1 or q0=-q1 then theta = 0 and we can return q0
         if (abs(cosHalfTheta) >= 1.0)
@@ -291,7 +316,7 @@ namespace Geometry
         }
         // Calculate temporary values.
         VALUE_TYPE halfTheta = acos(cosHalfTheta);
-        VALUE_TYPE sinHalfTheta = sqrt(1.0 - Common::Sqr(cosHalfTheta));
+        VALUE_TYPE sinHalfTheta = sqrt(1 - Numerics::Sqr(cosHalfTheta));
         // if theta = 180 degrees then result is not fully defined
         // we could rotate around any axis normal to q0 or q1
         if (abs(sinHalfTheta) < 0.001)
@@ -305,6 +330,56 @@ namespace Geometry
         return TQuaternion<VALUE_TYPE>((q0[0] * ratioA + q1[0] * ratioB), (q0[1] * ratioA + q1[1] * ratioB), (q0[2] * ratioA + q1[2] * ratioB), (q0[3] * ratioA + q1[3] * ratioB));
     }
 
+    // normalized linear interpolation, a cheaper approximation of Slerp with the same end points and smoothing
+    template<typename VALUE_TYPE>
+    TQuaternion<VALUE_TYPE> Nlerp(TQuaternion<VALUE_TYPE> const &q0, TQuaternion<VALUE_TYPE> const &q1, VALUE_TYPE t)
+    {
+        if (t >= 1)
+        {
+            return q1;
+        }
+        if (t <= 0)
+        {
+            return q0;
+        }
+        t = Internal::SmoothInterpolation(t);
+        // we want the shortest path
+        const VALUE_TYPE t1 = q0.InnerProduct(q1) < 0 ? -t : t;
+        return (q0*(1 - t) + q1*t1).Normalized();
+    }
+
+    // result[i] = Slerp(q0[i], q1[i], t), e.g. to animate many instances at once
+    template<typename VALUE_TYPE>
+    void Slerp(const TQuaternion<VALUE_TYPE>* q0, const TQuaternion<VALUE_TYPE>* q1, const size_t count, const VALUE_TYPE t, TQuaternion<VALUE_TYPE>* result)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            result[i] = Slerp(q0[i], q1[i], t);
+        }
+    }
+
+    // result[i] = Nlerp(q0[i], q1[i], t)
+    template<typename VALUE_TYPE>
+    void Nlerp(const TQuaternion<VALUE_TYPE>* q0, const TQuaternion<VALUE_TYPE>* q1, const size_t count, const VALUE_TYPE t, TQuaternion<VALUE_TYPE>* result)
+    {
+        if (t >= 1)
+        {
+            std::copy(q1, q1 + count, result);
+            return;
+        }
+        if (t <= 0)
+        {
+            std::copy(q0, q0 + count, result);
+            return;
+        }
+        const VALUE_TYPE s = Internal::SmoothInterpolation(t);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const VALUE_TYPE s1 = q0[i].InnerProduct(q1[i]) < 0 ? -s : s;
+            result[i] = (q0[i] * (1 - s) + q1[i] * s1).Normalized();
+        }
+    }
+
     template<typename VALUE_TYPE>
     TQuaternion<VALUE_TYPE> operator * (const VALUE_TYPE& value, const TQuaternion<VALUE_TYPE>& q)
     {
@@ -27,9 +27,10 @@ namespace Geometry
         {
             Copy(other);
         }
+        // quad doesn't need to be normalized, the matrix rotates like quad.Transform
         TRotationMatrix3(const quad_type &quad)
         {
-            quad.GetRotationMatrix3rows(m_data[0].GetData(),m_data[1].GetData(),m_data[2].GetData());
+            quad.Normalized().GetRotationMatrix3rows(m_data[0].GetData(),m_data[1].GetData(),m_data[2].GetData());
         }
 
         this_type &operator = (const this_type &other)
@@ -49,9 +50,9 @@ namespace Geometry
                  const value_type &b0, const value_type &b1, const value_type &b2, 
                  const value_type &c0, const value_type &c1, const value_type &c2)
         {
-            m_data[0].set(a0, a1, a2);
-            m_data[1].set(b0, b1, b2);
-            m_data[2].set(c0, c1, c2);
+            m_data[0].Set(a0, a1, a2);
+            m_data[1].Set(b0, b1, b2);
+            m_data[2].Set(c0, c1, c2);
         }
 
         bool operator == (const this_type &other) const
@@ -62,11 +63,12 @@ namespace Geometry
                 m_data[2] == other.m_data[2];
         }
 
-        const value_type &operator [] (const index_type &index) const
+        // rows
+        const vector_type &operator [] (const index_type &index) const
         {
             return m_data[index];
         }
-        value_type &operator [] (const index_type &index)
+        vector_type &operator [] (const index_type &index)
         {
             return m_data[index];
         }
@@ -75,6 +77,12 @@ namespace Geometry
         {
             return vector_type(m_data[0].InnerProduct(v), m_data[1].InnerProduct(v), m_data[2].InnerProduct(v));
         }
+
+        // result[i] = Transform(vectors[i]), result can be vectors
+        void Transform(const vector_type* vectors, const size_t count, vector_type* result) const
+        {
+            VectorBatch::Transform(*this, vectors, count, result);
+        }
     };
 };
 
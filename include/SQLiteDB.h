@@ -42,6 +42,9 @@ namespace SQLite
         std::string GetStringField(const std::string& field, const std::string& nullValue = "") const;
         std::vector<unsigned char> GetBlobField(int field) const;
         std::vector<unsigned char> GetBlobField(const std::string& field) const;
+        // zero-copy access; data is only valid until the next call to NextRow or Finalize
+        void GetBlobField(int field, const unsigned char*& data, int& length) const;
+        void GetBlobField(const std::string& field, const unsigned char*& data, int& length) const;
         bool FieldIsNull(int field) const;
         bool FieldIsNull(const std::string& field) const;
         bool IsEOF() const;
@@ -72,13 +75,49 @@ namespace SQLite
         void Bind(int param, const long long value);
         void Bind(int param, const double value);
         void Bind(int param, const unsigned char* value, int length);
+        void Bind(int param, const std::vector<unsigned char>& value);
+        // reserve a blob of length zero bytes, to be filled using a Blob
+        void BindZeroBlob(int param, int length);
         void BindNull(int param);
+        // bind the arguments to parameters 1..n, using the Bind overloads above
+        template<typename... TN>
+        void BindAll(TN&&... tn)
+        {
+            int param = 0;
+            std::initializer_list<char> {(static_cast<void>(Bind(++param, tn)), char{}) ...};
+        }
         void Reset();
         void Finalize();
     private:
         std::shared_ptr<State> m_state;
     };
 
+    // Incremental (streaming) access to a single blob, see DB::OpenBlob
+    class Blob
+    {
+    public:
+        class State;
+    public:
+        Blob();
+        Blob(std::shared_ptr<State>&& state);
+        Blob(Blob&& blob);
+        Blob(const Blob& blob);
+        ~Blob();
+
+        Blob& operator = (const Blob& blob);
+
+        bool IsOpen() const;
+        int GetSize() const;
+        // read/write length bytes at offset, using a caller supplied buffer; a blob can not change size.
+        void Read(unsigned char* buffer, int length, int offset = 0) const;
+        void Write(const unsigned char* buffer, int length, int offset = 0);
+        // move to the same column in another row
+        void Reopen(int64_t rowId);
+        void Close();
+    private:
+        std::shared_ptr<State> m_state;
+    };
+
     class DB
     {
     public:
@@ -89,6 +128,8 @@ namespace SQLite
 
         void Open(const std::string& fileName,bool readOnly);
         void Close();
+        // file name of the open db, empty for in-memory and temporary dbs
+        std::string GetFileName() const;
         bool TableExists(const std::string& tableName);
 
         int ExecDML(const std::string& sql);
@@ -126,14 +167,57 @@ namespace SQLite
             return CompileStatement(FormatArgs(fmt, t0, tn...));
         }
 
+        // Compiled statement for sql, taken from a LRU cache keyed by the sql text. The statement goes back
+        // into the cache (reset, bindings cleared) once the last Statement/Query using it is gone.
+        Statement PrepareStatement(const std::string& sql);
+        void SetStatementCacheSize(size_t size);
+        size_t GetStatementCacheCount() const;
+
+        // Same as the Exec* functions above, but the sql uses ? parameters which are bound to the arguments
+        // instead of formatted into the text; the compiled statement is reused between calls.
+        template<typename... TN>
+        int ExecDMLParams(const std::string& sql, TN&&... tn)
+        {
+            Statement statement = PrepareStatement(sql);
+            statement.BindAll(tn...);
+            return statement.ExecDML();
+        }
+
+        template<typename... TN>
+        Query ExecQueryParams(const std::string& sql, TN&&... tn)
+        {
+            Statement statement = PrepareStatement(sql);
+            statement.BindAll(tn...);
+            return statement.ExecQuery();
+        }
+
+        template<typename... TN>
+        int64_t ExecSingleInt64Params(const std::string& sql, TN&&... tn)
+        {
+            return GetSingleInt64(ExecQueryParams(sql, tn...));
+        }
+
+        template<typename... TN>
+        std::string ExecSingleStringParams(const std::string& sql, TN&&... tn)
+        {
+            return GetSingleString(ExecQueryParams(sql, tn...));
+        }
+
+        // open the blob in table.column at rowId for streaming read (and write)
+        Blob OpenBlob(const std::string& table, const std::string& column, int64_t rowId, bool readOnly = true);
+
         void BeginTransaction();
         void CommitTransaction();
+        void RollbackTransaction();
 
         int64_t LastRowId() const;
         void Interrupt();
         void SetBusyTimeout(int milliSecs);
         static std::string SQLiteVersion();
     private:
+        static int64_t GetSingleInt64(const Query& query);
+        static std::string GetSingleString(const Query& query);
+
         template<typename... Arguments>
         std::string FormatArgs(const std::string& fmt, const Arguments&... args)
         {
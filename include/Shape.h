@@ -10,8 +10,16 @@ namespace Geometry
         typedef unsigned int size_type;
         typedef unsigned int index_type;
     protected:
-        BoundingShape3d m_boundingShape;
+        mutable BoundingShape3d m_boundingShape;
         container_type m_hulls;
+        // see DeriveBoundingShape; Unknown for a bounding shape which is set
+        BoundingShape3d::Type m_derivedType;
+        mutable bool m_derivedValid;
+        mutable uint64_t m_derivedSignature;  // of the hulls and their generations the bounding shape was derived from
+        // identifies the db state written by the last Store or read by Retrieve, see StorageMode::Delta
+        mutable std::string m_storeToken;
+
+        friend class ShapeLibrary;
 
     public:
 
@@ -24,9 +32,13 @@ namespace Geometry
 
         virtual ~Shape();
 
-        const HullPtr& AddHull(const HullPtr& hull) { return *m_hulls.emplace(hull).first; }
+        // a shape whose hulls share the geometry of the hulls of this shape until either one modifies it
+        // (see Hull::Instance); its transformations, colors and render modes are its own
+        ShapePtr Instance() const;
+
+        const HullPtr& AddHull(const HullPtr& hull) { m_derivedValid = false; return *m_hulls.emplace(hull).first; }
         const HullPtr& AddHull(const HullRaw& hull) { return AddHull(hull.lock()); }
-        void RemoveHull(const HullPtr& hull) { m_hulls.erase(hull); }
+        void RemoveHull(const HullPtr& hull) { m_derivedValid = false; m_hulls.erase(hull); }
         void RemoveHull(const HullRaw& hull) { RemoveHull(hull.lock()); }
         template<typename... Args>
         const HullPtr& ConstructAndAddHull(Args&&... args)
@@ -39,6 +51,7 @@ namespace Geometry
         template<typename ITER>
         void SetHulls(ITER& iterBegin, ITER& iterEnd)
         {
+            m_derivedValid = false;
             m_hulls.clear();
             for (auto iter = iterBegin; iter != iterEnd; ++iter)
             {
@@ -74,30 +87,83 @@ namespace Geometry
         // Make sure the shape exists solely out of triangles
         void Triangulate();
 
-        const BoundingShape3d& GetBoundingShape() const { return m_boundingShape; }
-        void SetBoundingShape(const BoundingShape3d& boundingShape) { m_boundingShape = boundingShape; }
+        const BoundingShape3d& GetBoundingShape() const { if (m_derivedType != BoundingShape3d::Type::Unknown) UpdateDerivedBoundingShape(); return m_boundingShape; }
+        // a set bounding shape is only changed by the transformations of the shape; stops DeriveBoundingShape
+        void SetBoundingShape(const BoundingShape3d& boundingShape) { m_derivedType = BoundingShape3d::Type::Unknown; m_boundingShape = boundingShape; }
+
+        // Derive the bounding shape (a Ball or a Box) from the bounding shapes of the hulls, without visiting any
+        // vertices. It is brought up to date by GetBoundingShape when hulls have been added, removed or modified
+        // since. It is Unknown as long as a hull has no bounding shape. Unknown sets the bounding shape instead.
+        void DeriveBoundingShape(const BoundingShape3d::Type type);
 
         // Convenience functions which work on all hulls at once
         void Invalidate() { ForEachHull([](const HullRaw& hull) {hull->Invalidate(); }); }
         void SetColor(const ColorPtr& color) { ForEachHull([&](const HullRaw& hull) {hull->SetColor(color); }); }
         void SetRenderMode(const RenderMode renderMode) { ForEachHull([&](const HullRaw& hull) {hull->SetRenderMode(renderMode); }); }
 
-        // scale/translate all hull coordinates in this shape in parallel
+        // scale/translate/rotate all hull coordinates in this shape in parallel; the bounding shapes of the shape
+        // and the hulls are transformed along
         void Scale(const double factor);
         void Translate(const Vector3d& translation);
+        void Rotate(const Quat& rotation);
+
+        // Recalculate the hull balls and boxes which aren't optimal (anymore), for instance after a rotation, in
+        // parallel. Meant to run when there is time to spare; the shape's own bounding shape is left alone.
+        void RefineBoundingShapes();
 
         // calculate an approximate volume of the shape
         double CalculateVolume() const;
 
+        // Validate every hull (see Hull::Validate); the report is the sum of the hull reports
+        Hull::ValidationReport Validate() const;
+
         // geometry operations
         void Add(ShapePtr& other);       // A joined with B
         void Subtract(ShapePtr& other);  // A minus overlap with B 
 
-        // Store/Retrieve shape to db.
-        void Store(SQLite::DB& db) const;
-        void Retrieve(SQLite::DB& db);
+        // Layout of the shape in the db
+        enum class StorageMode
+        {
+            Rows,       // one row per vertex, normal, edge and face (version 1)
+            BulkRows,   // same layout as Rows, written with multi-row inserts and relaxed journaling/syncing
+            Blobs,      // per hull a few blobs with packed arrays, see ShapeFormat.h (version 2)
+            Delta       // Blobs, only rewriting hulls modified since the last Store/Retrieve of this shape on this db;
+                        // falls back to Blobs when the db has been written by something else since
+        };
+
+        // Time (ms) spent in the phases of Retrieve. Phases run concurrently, so they can add up to more than the total.
+        struct RetrieveTimings
+        {
+            double m_header;    // header, bounding shapes
+            double m_read;      // fetching rows and blobs from the db (rows layout: including vertices, normals, texture coords)
+            double m_build;     // constructing hulls, faces and edges
+            double m_link;      // linking edges to their twin/next/prev (rows layout only)
+            double m_check;     // checking the result
+            double m_total;
+        };
+
+        // Store/Retrieve shape to db. Retrieve reads both layouts and throws std::runtime_error on an unsupported db.
+        // Tables which don't depend on each other are read concurrently; for a file db on separate read-only connections.
+        void Store(SQLite::DB& db, const StorageMode mode = StorageMode::Blobs) const;
+        void Retrieve(SQLite::DB& db, RetrieveTimings* timings = nullptr);
+
+        // Save/Load shape to a binary stream (see ShapeFormat.h); the stream has to be opened in binary mode.
+        // Load throws std::runtime_error on a malformed stream.
+        void Save(std::ostream& stream) const;
+        void Load(std::istream& stream);
     protected:
         void Clear();
+
+        void UpdateDerivedBoundingShape() const;
+
+        // the hulls to serialize; instanced hulls are replaced by a transformed copy owned by 'materialized'
+        std::vector<HullRaw> GetMaterializedHulls(Shape& materialized) const;
+
+        // true when the db still holds what this shape last stored in it (or retrieved from it)
+        bool CanStoreDelta(SQLite::DB& db) const;
+
+        void RetrieveRows(SQLite::DB& db, std::unordered_map<size_t, BoundingShape3d>& boundingShapes, RetrieveTimings& timings);
+        void RetrieveBlobs(SQLite::DB& db, std::unordered_map<size_t, BoundingShape3d>& boundingShapes, RetrieveTimings& timings);
     };
 }
 
@@ -0,0 +1,150 @@
+#pragma once
+
+namespace Geometry
+{
+    /* ShapeFormat : layout of the binary shape file written by Shape::Save and read by Shape::Load
+     *
+     * The file consists of a FileHeader followed by flat arrays (sections). Every section starts at an
+     * 8 byte aligned offset which is recorded in the header, so a reader can fetch each section with a
+     * single bulk read (or map the file). All references between elements are indices into these arrays;
+     * NoIndex marks a missing reference. Values are stored in native (little endian) byte order.
+     *
+     *   vertices      : PackedVector3[vertexCount]
+     *   normals       : PackedVector3[normalCount]
+     *   textureCoords : PackedVector2[textureCoordCount]
+     *   colors        : uint32_t[colorCount]            (RGBA, see TRGBAColor::GetInt)
+     *   edges         : PackedEdge[edgeCount]           (grouped per face, in loop order)
+     *   faces         : PackedFace[faceCount]           (grouped per hull)
+     *   hulls         : PackedHull[hullCount]
+     */
+    namespace ShapeFormat
+    {
+        static const char Magic[8] = { '3','D','M','S','H','A','P','E' };
+        static const uint32_t Version = 1;
+        static const uint32_t NoIndex = 0xFFFFFFFF;
+
+        struct PackedVector3
+        {
+            double m_data[3];
+        };
+
+        struct PackedVector2
+        {
+            double m_data[2];
+        };
+
+        struct PackedBoundingShape
+        {
+            enum Type : uint32_t
+            {
+                Unknown = 0,
+                Ball = 1,
+                Box = 2
+            };
+            uint32_t m_type;
+            uint32_t m_optimal;
+            PackedVector3 m_p0;     // center (ball) or min (box)
+            PackedVector3 m_p1;     // max (box)
+            double m_radius;        // radius (ball)
+        };
+
+        struct PackedEdge
+        {
+            uint32_t m_vertex;
+            uint32_t m_normal;
+            uint32_t m_textureCoord;
+            uint32_t m_color;
+            uint32_t m_face;
+            uint32_t m_twin;
+            uint32_t m_next;
+            uint32_t m_prev;
+        };
+
+        struct PackedFace
+        {
+            uint32_t m_firstEdge;
+            uint32_t m_edgeCount;
+            uint32_t m_normal;
+            uint32_t m_color;
+        };
+
+        struct PackedHull
+        {
+            uint32_t m_firstFace;
+            uint32_t m_faceCount;
+            uint32_t m_orientation; // 0 = outward, 1 = inward
+            uint32_t m_color;
+            PackedBoundingShape m_boundingShape;
+        };
+
+        struct Section
+        {
+            uint64_t m_offset;      // from the start of the file
+            uint64_t m_count;       // number of elements
+        };
+
+        struct FileHeader
+        {
+            char m_magic[8];
+            uint32_t m_version;
+            uint32_t m_headerSize;  // sizeof(FileHeader) of the writer
+            Section m_vertices;
+            Section m_normals;
+            Section m_textureCoords;
+            Section m_colors;
+            Section m_edges;
+            Section m_faces;
+            Section m_hulls;
+            PackedBoundingShape m_boundingShape;
+        };
+
+        static_assert(sizeof(PackedEdge) == 32, "unexpected PackedEdge layout");
+        static_assert(sizeof(PackedFace) == 16, "unexpected PackedFace layout");
+        static_assert(sizeof(PackedHull) % 8 == 0, "unexpected PackedHull layout");
+        static_assert(sizeof(FileHeader) % 8 == 0, "unexpected FileHeader layout");
+
+        // Sections of a shape file in memory
+        struct View
+        {
+            FileHeader m_header;
+            const PackedVector3* m_vertices;
+            const PackedVector3* m_normals;
+            const PackedVector2* m_textureCoords;
+            const uint32_t* m_colors;
+            const PackedEdge* m_edges;
+            const PackedFace* m_faces;
+            const PackedHull* m_hulls;
+        };
+
+        // Owned sections, used while reading and writing
+        struct Arrays
+        {
+            std::vector<PackedVector3> m_vertices;
+            std::vector<PackedVector3> m_normals;
+            std::vector<PackedVector2> m_textureCoords;
+            std::vector<uint32_t> m_colors;
+            std::vector<PackedEdge> m_edges;
+            std::vector<PackedFace> m_faces;
+            std::vector<PackedHull> m_hulls;
+        };
+
+        // Convert between BoundingShape3d and its packed representation. An OrientedBox is packed as the (non optimal)
+        // axis aligned box around it.
+        PackedBoundingShape Pack(const BoundingShape3d& boundingShape);
+        BoundingShape3d Unpack(const PackedBoundingShape& boundingShape);
+
+        // Throws std::runtime_error if the header is not from a supported shape file
+        void CheckHeader(const FileHeader& header);
+        // Locate the sections of a complete shape file in memory (for instance a mapped file)
+        View GetView(const void* data, const uint64_t size);
+        // View on owned sections
+        View GetView(const Arrays& arrays);
+
+        // Pack hulls into flat arrays; indices are local to the arrays
+        Arrays Pack(const std::vector<HullRaw>& hulls);
+        // Build the hulls, faces and edges described by view into shape (the shape bounding shape is left alone),
+        // returns the new hulls in the order of the view. Indices are checked, the resulting half edge structure is
+        // not: validate it once the shape is complete (see Shape::Validate).
+        std::vector<HullRaw> Unpack(const View& view, Shape& shape);
+    }
+}
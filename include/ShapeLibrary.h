@@ -0,0 +1,46 @@
+#pragma once
+
+namespace Geometry
+{
+    /* ShapeLibrary : db holding any number of named shapes
+     *
+     * The hulls of all shapes share one Hulls table in the blob layout of Shape::Store (StorageMode::Blobs),
+     * each row refers to its shape. Retrieve can return a proxy shape: the hulls are created with their
+     * orientation, color and bounding shape (so they can be culled), their geometry is loaded from the
+     * library on first access (see Hull::SetLoader). Proxy hulls keep the connection of the library open
+     * until they are loaded; loading a hull of a shape removed from the library meanwhile throws.
+     */
+    class ShapeLibrary
+    {
+    public:
+        struct Entry
+        {
+            int64_t m_id;
+            std::string m_name;
+        };
+
+        ShapeLibrary();
+        ~ShapeLibrary();
+
+        // Open (or create) a library db; throws std::runtime_error if the db holds something else.
+        void Open(const std::string& fileName, bool readOnly);
+        void Close();
+        bool IsOpen() const;
+
+        // The shapes in the library, ordered by id
+        std::vector<Entry> GetShapes() const;
+
+        // Add a copy of shape, returns the id of the new shape. Hulls without a bounding shape get a ball.
+        int64_t Add(const std::string& name, const Shape& shape);
+        void Remove(const int64_t id);
+
+        // Retrieve a shape; with lazy the hull geometry is loaded on first access. Throws std::runtime_error for an unknown id.
+        ShapePtr Retrieve(const int64_t id, const bool lazy = true) const;
+
+    private:
+        class State;
+        std::shared_ptr<State> m_state;
+
+        State& GetState() const;
+    };
+}
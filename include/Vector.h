@@ -31,6 +31,15 @@ namespace Geometry
         {
             Set(data);
         }
+        // conversion between precisions (e.g. Vector3d <-> Vector3f)
+        template<typename OTHER_VALUE_TYPE>
+        explicit TVector(const TVector<OTHER_VALUE_TYPE, DIMENSION> &other)
+        {
+            for (index_type i = 0; i < dimension; ++i)
+            {
+                m_data[i] = (value_type)other[i];
+            }
+        }
 
         this_type &operator = (const this_type &other)
         {
@@ -87,21 +96,16 @@ namespace Geometry
             return m_data.data();
         }
 
-    private:
-        template<index_type index>
-        bool IsEqualIndex(const this_type &other) const
-        {
-            return Numerics::Equal(m_data[index], other.m_data[index]) && IsEqualIndex<index + 1>(other);
-        }
-        template<>
-        bool IsEqualIndex<dimension>(const this_type &other) const
-        {
-            return true;
-        }
-    public:
         bool operator == (const this_type &other) const
         {
-            return IsEqualIndex<0>(other);
+            for (index_type i = 0; i < dimension; ++i)
+            {
+                if (!Numerics::Equal(m_data[i], other.m_data[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
         }
 
         const value_type &operator [] (const index_type &index) const
@@ -150,12 +154,7 @@ namespace Geometry
         }
         value_type LengthSquared() const
         {
-            value_type res = pow(m_data[0],2);
-            for (index_type i = 1; i < dimension; ++i)
-            {
-                res += pow(m_data[i],2);
-            }
-            return res;
+            return InnerProduct(*this);
         }
 
         this_type &Normalize() 
@@ -0,0 +1,72 @@
+#pragma once
+
+namespace Geometry
+{
+    /* VectorBatch : operations on arrays of vectors (hot loops over the vertices of a face or hull)
+     *
+     * The operations of TVector itself are loops over a few elements which the compiler unrolls; SIMD pays off
+     * over many vectors instead. The Vector3d versions process 2 vectors per instruction (SSE2), other vector
+     * types use the generic loops. The vectors stay in their normal (array of structures) layout, so the
+     * arrays can be the vertices of a shape or a mapped shape file.
+     */
+    namespace VectorBatch
+    {
+        // result[i] = DistanceSquared(points[i], point)
+        template<typename VALUE_TYPE, unsigned int DIMENSION>
+        void DistancesSquared(const TVector<VALUE_TYPE, DIMENSION>* points, const size_t count, const TVector<VALUE_TYPE, DIMENSION>& point, VALUE_TYPE* result)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                result[i] = DistanceSquared(points[i], point);
+            }
+        }
+        void DistancesSquared(const Vector3d* points, const size_t count, const Vector3d& point, double* result);
+
+        // result[i] = vectors[i].InnerProduct(direction)
+        template<typename VALUE_TYPE, unsigned int DIMENSION>
+        void InnerProducts(const TVector<VALUE_TYPE, DIMENSION>* vectors, const size_t count, const TVector<VALUE_TYPE, DIMENSION>& direction, VALUE_TYPE* result)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                result[i] = vectors[i].InnerProduct(direction);
+            }
+        }
+        void InnerProducts(const Vector3d* vectors, const size_t count, const Vector3d& direction, double* result);
+
+        // result[i] = matrix.Transform(vectors[i]), result can be vectors
+        template<typename VALUE_TYPE>
+        void Transform(const TRotationMatrix3<VALUE_TYPE>& matrix, const TVector3<VALUE_TYPE>* vectors, const size_t count, TVector3<VALUE_TYPE>* result)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                result[i] = matrix.Transform(vectors[i]);
+            }
+        }
+        void Transform(const RotationMatrix3d& matrix, const Vector3d* vectors, const size_t count, Vector3d* result);
+
+        // index of the point furthest from point (the first one on a tie), count has to be > 0
+        template<typename VALUE_TYPE, unsigned int DIMENSION>
+        size_t Farthest(const TVector<VALUE_TYPE, DIMENSION>* points, const size_t count, const TVector<VALUE_TYPE, DIMENSION>& point)
+        {
+            assert(count > 0);
+            const size_t BlockSize = 256;
+            VALUE_TYPE distances[BlockSize];
+            size_t farthest = 0;
+            VALUE_TYPE max = -1;
+            for (size_t begin = 0; begin < count; begin += BlockSize)
+            {
+                const size_t size = std::min(BlockSize, count - begin);
+                DistancesSquared(points + begin, size, point, distances);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (distances[i] > max)
+                    {
+                        max = distances[i];
+                        farthest = begin + i;
+                    }
+                }
+            }
+            return farthest;
+        }
+    }
+}
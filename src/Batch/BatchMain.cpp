@@ -0,0 +1,266 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+using namespace std;
+
+#include "Geometry.h"
+using namespace Geometry;
+
+#include "Pipeline.h"
+using namespace Batch;
+
+/* 3DModelingBatch : run a pipeline of geometry operations on many shape files without a display
+ *
+ *   3DModelingBatch --script <stages> [--threads <n>] [--output <dir>] [--report <file>] <input>...
+ *
+ * Every input is a db written by Shape::Store. The inputs are divided over a pool of worker threads, each worker
+ * retrieves a shape, runs the pipeline (see Pipeline.h) and optionally stores the result in <dir> under the same
+ * file name. The report is a csv file with one row per stage per input (time, faces, result); a summary with the
+ * throughput and the time spent per stage is written to stdout.
+ */
+
+namespace
+{
+    struct Job
+    {
+        std::string m_input;
+        std::vector<Pipeline::StageResult> m_results;
+        std::string m_error;    // empty on success
+    };
+
+    struct Options
+    {
+        std::string m_script;
+        std::string m_output;
+        std::string m_report;
+        unsigned int m_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> m_inputs;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: 3DModelingBatch --script <stages> [--threads <n>] [--output <dir>] [--report <file>] <input>..." << std::endl
+                  << "  stages: comma separated list of triangulate, split, scale=<f>, translate=<x>;<y>;<z>, add=<file>, volume, validate" << std::endl;
+    }
+
+    Options ParseArguments(int argc, char* argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            auto GetValue = [&]()
+            {
+                if (++i == argc)
+                {
+                    throw std::runtime_error("Missing value for " + argument);
+                }
+                return std::string(argv[i]);
+            };
+            if (argument == "--script")
+            {
+                options.m_script = GetValue();
+            }
+            else if (argument == "--threads")
+            {
+                const int threads = std::atoi(GetValue().c_str());
+                if (threads < 1)
+                {
+                    throw std::runtime_error("Invalid number of threads");
+                }
+                options.m_threads = (unsigned int)threads;
+            }
+            else if (argument == "--output")
+            {
+                options.m_output = GetValue();
+            }
+            else if (argument == "--report")
+            {
+                options.m_report = GetValue();
+            }
+            else if (argument.compare(0, 2, "--") == 0)
+            {
+                throw std::runtime_error("Unknown option " + argument);
+            }
+            else
+            {
+                options.m_inputs.emplace_back(argument);
+            }
+        }
+        if (options.m_script.empty() || options.m_inputs.empty())
+        {
+            throw std::runtime_error("No script or no input");
+        }
+        return options;
+    }
+
+    std::string GetFileName(const std::string& path)
+    {
+        const size_t separator = path.find_last_of("/\\");
+        return separator == std::string::npos ? path : path.substr(separator + 1);
+    }
+
+    double MillisecondsSince(const std::chrono::steady_clock::time_point& start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void RunJob(const Pipeline& pipeline, const Options& options, Job& job)
+    {
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+            ShapePtr shape = RetrieveShape(job.m_input);
+            job.m_results.push_back({ "retrieve", MillisecondsSince(start), CountFaces(*shape), "" });
+
+            pipeline.Run(*shape, job.m_results);
+
+            if (!options.m_output.empty())
+            {
+                start = std::chrono::steady_clock::now();
+                StoreShape(*shape, options.m_output + "/" + GetFileName(job.m_input));
+                job.m_results.push_back({ "store", MillisecondsSince(start), CountFaces(*shape), "" });
+            }
+        }
+        catch (const std::exception& e)
+        {
+            job.m_error = e.what();
+        }
+    }
+
+    std::string Quote(const std::string& text)
+    {
+        std::string res = "\"";
+        for (const char c : text)
+        {
+            res += c;
+            if (c == '"')
+            {
+                res += c;
+            }
+        }
+        return res + "\"";
+    }
+
+    void WriteReport(const std::vector<Job>& jobs, const std::string& fileName)
+    {
+        std::ofstream stream(fileName, std::ios::out | std::ios::trunc);
+        if (!stream)
+        {
+            throw std::runtime_error("Unable to write " + fileName);
+        }
+        stream << "Input,Stage,Milliseconds,Faces,Result" << std::endl;
+        for (const Job& job : jobs)
+        {
+            for (const Pipeline::StageResult& result : job.m_results)
+            {
+                stream << Quote(job.m_input) << ',' << Quote(result.m_stage) << ',' << boost::format("%1$.3f") % result.m_ms << ',' << result.m_faces << ',' << Quote(result.m_result) << std::endl;
+            }
+            if (!job.m_error.empty())
+            {
+                stream << Quote(job.m_input) << ",\"error\",,," << Quote(job.m_error) << std::endl;
+            }
+        }
+    }
+
+    void WriteSummary(const std::vector<Job>& jobs, const unsigned int threads, const double ms)
+    {
+        // per stage, in order of first appearance
+        std::vector<std::string> stages;
+        std::map<std::string, Profiling::Statistics> statistics;
+        size_t failed = 0;
+        for (const Job& job : jobs)
+        {
+            for (const Pipeline::StageResult& result : job.m_results)
+            {
+                auto inserted = statistics.emplace(result.m_stage, Profiling::Statistics{ 0, 0, 0, 0 });
+                if (inserted.second)
+                {
+                    stages.emplace_back(result.m_stage);
+                }
+                Profiling::Statistics& s = inserted.first->second;
+                ++s.m_calls;
+                s.m_totalMs += result.m_ms;
+                s.m_maxMs = std::max(s.m_maxMs, result.m_ms);
+                s.m_elements += result.m_faces;
+            }
+            if (!job.m_error.empty())
+            {
+                ++failed;
+                std::cerr << job.m_input << ": " << job.m_error << std::endl;
+            }
+        }
+        std::cout << boost::format("%1% inputs (%2% failed) on %3% threads in %4$.1f ms, %5$.2f inputs/s") % jobs.size() % failed % threads % ms % (jobs.size() * 1000.0 / ms) << std::endl;
+        std::cout << boost::format("%|-24| %|10| %|12| %|12| %|12|") % "stage" % "runs" % "total ms" % "mean ms" % "max ms" << std::endl;
+        for (const std::string& stage : stages)
+        {
+            const Profiling::Statistics& s = statistics[stage];
+            std::cout << boost::format("%|-24| %|10| %|12.1f| %|12.3f| %|12.3f|") % stage % s.m_calls % s.m_totalMs % (s.m_totalMs / s.m_calls) % s.m_maxMs << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::unique_ptr<Pipeline> pipeline;
+    try
+    {
+        options = ParseArguments(argc, argv);
+        pipeline = std::make_unique<Pipeline>(options.m_script);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector<Job> jobs;
+        for (const std::string& input : options.m_inputs)
+        {
+            jobs.push_back({ input, {}, "" });
+        }
+
+        // workers take the next job until all are done
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        const unsigned int threads = (unsigned int)std::min<size_t>(options.m_threads, jobs.size());
+        for (unsigned int i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([&]()
+            {
+                for (size_t job = next++; job < jobs.size(); job = next++)
+                {
+                    RunJob(*pipeline, options, jobs[job]);
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        const double ms = MillisecondsSince(start);
+
+        if (!options.m_report.empty())
+        {
+            WriteReport(jobs, options.m_report);
+        }
+        WriteSummary(jobs, threads, ms);
+
+        const bool failed = std::any_of(jobs.begin(), jobs.end(), [](const Job& job) { return !job.m_error.empty(); });
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
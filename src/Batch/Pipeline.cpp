@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdio>
+using namespace std;
+
+#include "Geometry.h"
+using namespace Geometry;
+
+#include "Pipeline.h"
+using namespace Batch;
+
+namespace
+{
+    std::vector<std::string> Split(const std::string& text, const char separator)
+    {
+        std::vector<std::string> parts;
+        size_t begin = 0;
+        for (size_t end = text.find(separator); end != std::string::npos; end = text.find(separator, begin))
+        {
+            parts.emplace_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        parts.emplace_back(text.substr(begin));
+        return parts;
+    }
+
+    double ToDouble(const std::string& stage, const std::string& text)
+    {
+        size_t used = 0;
+        double value = 0;
+        try
+        {
+            value = std::stod(text, &used);
+        }
+        catch (const std::exception&)
+        {
+        }
+        if (used == 0 || used != text.size())
+        {
+            throw std::runtime_error("Invalid number '" + text + "' in stage '" + stage + "'");
+        }
+        return value;
+    }
+
+    void CheckArguments(const std::string& stage, const std::vector<std::string>& arguments, const size_t count)
+    {
+        if (arguments.size() != count)
+        {
+            throw std::runtime_error((boost::format("Stage '%1%' takes %2% argument(s)") % stage % count).str());
+        }
+    }
+}
+
+Pipeline::Pipeline(const std::string& script)
+{
+    for (const std::string& text : Split(script, ','))
+    {
+        const size_t equals = text.find('=');
+        const std::string name = text.substr(0, equals);
+        const std::vector<std::string> arguments = equals == std::string::npos ? std::vector<std::string>() : Split(text.substr(equals + 1), ';');
+        std::function<std::string(Shape& shape)> func;
+        if (name == "triangulate")
+        {
+            CheckArguments(text, arguments, 0);
+            func = [](Shape& shape) { shape.Triangulate(); return std::string(); };
+        }
+        else if (name == "split")
+        {
+            CheckArguments(text, arguments, 0);
+            func = [](Shape& shape) { shape.SplitTrianglesIn4(); return std::string(); };
+        }
+        else if (name == "scale")
+        {
+            CheckArguments(text, arguments, 1);
+            const double factor = ToDouble(text, arguments[0]);
+            func = [factor](Shape& shape) { shape.Scale(factor); return std::string(); };
+        }
+        else if (name == "translate")
+        {
+            CheckArguments(text, arguments, 3);
+            const Vector3d translation(ToDouble(text, arguments[0]), ToDouble(text, arguments[1]), ToDouble(text, arguments[2]));
+            func = [translation](Shape& shape) { shape.Translate(translation); return std::string(); };
+        }
+        else if (name == "add")
+        {
+            CheckArguments(text, arguments, 1);
+            const std::string fileName = arguments[0];
+            // Add takes over the hulls of the other shape, so every run gets a fresh copy
+            func = [fileName](Shape& shape) { ShapePtr other = RetrieveShape(fileName); shape.Add(other); return std::string(); };
+        }
+        else if (name == "volume")
+        {
+            CheckArguments(text, arguments, 0);
+            func = [](Shape& shape) { return (boost::format("%1$.12g") % shape.CalculateVolume()).str(); };
+        }
+        else if (name == "validate")
+        {
+            CheckArguments(text, arguments, 0);
+            func = [](Shape& shape) { const Hull::ValidationReport report = shape.Validate(); report.Check("Invalid shape"); return (boost::format("checksum %1$016x") % report.m_checksum).str(); };
+        }
+        else
+        {
+            throw std::runtime_error("Unknown stage '" + text + "'");
+        }
+        m_stages.push_back({ text, func });
+    }
+}
+
+std::vector<std::string> Pipeline::GetStages() const
+{
+    std::vector<std::string> stages;
+    for (const Stage& stage : m_stages)
+    {
+        stages.emplace_back(stage.m_name);
+    }
+    return stages;
+}
+
+void Pipeline::Run(Shape& shape, std::vector<StageResult>& results) const
+{
+    for (const Stage& stage : m_stages)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::string result = stage.m_func(shape);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        results.push_back({ stage.m_name, ms, CountFaces(shape), result });
+    }
+}
+
+ShapePtr Batch::RetrieveShape(const std::string& fileName)
+{
+    SQLite::DB db;
+    db.Open(fileName, true);
+    ShapePtr shape = Construct<Shape>();
+    shape->Retrieve(db);
+    return shape;
+}
+
+void Batch::StoreShape(const Shape& shape, const std::string& fileName)
+{
+    std::remove(fileName.c_str());
+    SQLite::DB db;
+    db.Open(fileName, false);
+    shape.Store(db);
+}
+
+size_t Batch::CountFaces(const Shape& shape)
+{
+    size_t count = 0;
+    shape.ForEachHull([&count](const HullRaw& hull) { count += hull->GetFaces().size(); });
+    return count;
+}
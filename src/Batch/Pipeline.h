@@ -0,0 +1,52 @@
+#pragma once
+
+namespace Batch
+{
+    /* Pipeline : chain of operations executed on a shape
+     *
+     * The script is a comma separated list of stages, e.g. "triangulate,split,scale=2,volume":
+     *
+     *   triangulate            Shape::Triangulate
+     *   split                  Shape::SplitTrianglesIn4
+     *   scale=<f>              Shape::Scale
+     *   translate=<x>;<y>;<z>  Shape::Translate
+     *   add=<file>             Shape::Add with the shape stored in <file>
+     *   volume                 Shape::CalculateVolume, the volume is the result of the stage
+     *   validate               Shape::Validate, throws when the shape is invalid; the checksum is the result
+     *
+     * A pipeline doesn't change after construction, so one pipeline can be run by many threads at once.
+     */
+    class Pipeline
+    {
+    public:
+        struct StageResult
+        {
+            std::string m_stage;
+            double m_ms;
+            size_t m_faces;         // after the stage
+            std::string m_result;   // empty for stages without a result
+        };
+
+        // throws std::runtime_error on an invalid script
+        Pipeline(const std::string& script);
+
+        std::vector<std::string> GetStages() const;
+
+        // Results are added as the stages finish; when a stage throws the results of the previous stages are kept.
+        void Run(Geometry::Shape& shape, std::vector<StageResult>& results) const;
+
+    private:
+        struct Stage
+        {
+            std::string m_name;
+            std::function<std::string(Geometry::Shape& shape)> m_func;
+        };
+        std::vector<Stage> m_stages;
+    };
+
+    // Retrieve/Store a shape from/to a db file (see Shape::Store); StoreShape replaces an existing file
+    Geometry::ShapePtr RetrieveShape(const std::string& fileName);
+    void StoreShape(const Geometry::Shape& shape, const std::string& fileName);
+
+    size_t CountFaces(const Geometry::Shape& shape);
+}; // Batch
@@ -0,0 +1,457 @@
+#include "benchmark/benchmark.h"
+
+#include "Geometry.h"
+using namespace Geometry;
+
+// Benchmarks of the hot paths of the Geometry library. All input is generated with fixed seeds, so runs are
+// comparable; track regressions with the JSON output:
+//
+//   3DModelingBenchmark --benchmark_out=benchmark.json --benchmark_out_format=json
+//
+// Mesh sizes are given as the number of SplitTrianglesIn4 rounds on a Dodecahedron (60 * 4^n faces):
+// 0: 60, 2: 960, 5: 61440, 7: 983040 faces.
+
+namespace
+{
+    ShapePtr CreateDodecahedron(const int splits)
+    {
+        ShapePtr shape = Construct<Dodecahedron>();
+        for (int i = 0; i < splits; ++i)
+        {
+            shape->SplitTrianglesIn4();
+        }
+        return shape;
+    }
+
+    size_t FaceCount(const Shape& shape)
+    {
+        size_t count = 0;
+        shape.ForEachHull([&count](const HullRaw& hull) { count += hull->GetFaces().size(); });
+        return count;
+    }
+
+    // Prism with two n-gon caps and n quads
+    ShapePtr CreatePrism(const int n)
+    {
+        ShapePtr shape = Construct<Shape>();
+        HullPtr hull = shape->ConstructAndAddHull();
+        std::vector<VertexPtr> bottom, top;
+        for (int i = 0; i < n; ++i)
+        {
+            const double angle = 2 * Numerics::Constants::Pi * i / n;
+            bottom.emplace_back(Construct<Vertex>(cos(angle), sin(angle), 0));
+            top.emplace_back(Construct<Vertex>(cos(angle), sin(angle), 1));
+        }
+        std::map<std::pair<Vertex*, Vertex*>, EdgeRaw> edges;
+        auto AddFace = [&](const std::vector<VertexPtr>& vertices)
+        {
+            FacePtr face = hull->ConstructAndAddFace();
+            std::vector<EdgeRaw> ring;
+            for (const VertexPtr& vertex : vertices)
+            {
+                ring.emplace_back(face->ConstructAndAddEdge(vertex));
+            }
+            for (size_t i = 0; i < ring.size(); ++i)
+            {
+                ring[i]->SetNext(ring[(i + 1) % ring.size()]);
+                ring[i]->SetPrev(ring[(i + ring.size() - 1) % ring.size()]);
+                edges.emplace(std::make_pair(vertices[i].get(), vertices[(i + 1) % ring.size()].get()), ring[i]);
+            }
+        };
+        AddFace(top);
+        AddFace(std::vector<VertexPtr>(bottom.rbegin(), bottom.rend()));
+        for (int i = 0; i < n; ++i)
+        {
+            const int j = (i + 1) % n;
+            AddFace({ bottom[i], bottom[j], top[j], top[i] });
+        }
+        for (auto& edge : edges)
+        {
+            edge.second->SetTwin(edges[std::make_pair(edge.first.second, edge.first.first)]);
+        }
+        shape->ForEachFace([](const FaceRaw& face) { face->CalcNormal(); });
+        shape->Validate().Check("Invalid prism");
+        return shape;
+    }
+
+    // reproducible unit vectors and rotations
+    std::vector<Vector3d> RandomVectors(const size_t count)
+    {
+        std::mt19937 generator(12345);
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        std::vector<Vector3d> vectors;
+        vectors.reserve(count);
+        while (vectors.size() < count)
+        {
+            Vector3d v(distribution(generator), distribution(generator), distribution(generator));
+            if (v.LengthSquared() > 0.01)
+            {
+                vectors.emplace_back(v.Normalized());
+            }
+        }
+        return vectors;
+    }
+
+    std::vector<Quat> RandomRotations(const size_t count)
+    {
+        std::mt19937 generator(54321);
+        std::uniform_real_distribution<double> distribution(0, 2 * Numerics::Constants::Pi);
+        std::vector<Quat> rotations;
+        for (const Vector3d& axis : RandomVectors(count))
+        {
+            rotations.emplace_back(axis, distribution(generator));
+        }
+        return rotations;
+    }
+
+    const size_t KernelSize = 4096;
+
+    // balls and boxes spread over a 100x100x100 area
+    std::vector<BoundingShape3d> RandomBoundingShapes(const size_t count)
+    {
+        std::mt19937 generator(777);
+        std::uniform_real_distribution<double> position(-50, 50);
+        std::uniform_real_distribution<double> size(0.5, 2);
+        std::vector<BoundingShape3d> shapes;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3d center(position(generator), position(generator), position(generator));
+            const Vector3d halfSize(size(generator), size(generator), size(generator));
+            if (i % 2)
+            {
+                shapes.emplace_back(center, halfSize[0]);
+            }
+            else
+            {
+                shapes.emplace_back(center - halfSize, center + halfSize);
+            }
+        }
+        return shapes;
+    }
+}
+
+static void BM_DodecahedronConstruction(benchmark::State& state)
+{
+    size_t faces = 0;
+    for (auto _ : state)
+    {
+        ShapePtr shape = CreateDodecahedron((int)state.range(0));
+        faces = FaceCount(*shape);
+        benchmark::DoNotOptimize(shape);
+    }
+    state.counters["faces"] = (double)faces;
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+BENCHMARK(BM_DodecahedronConstruction)->Arg(0)->Arg(2)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+
+static void BM_SplitTrianglesIn4(benchmark::State& state)
+{
+    size_t faces = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ShapePtr shape = CreateDodecahedron((int)state.range(0));
+        faces = FaceCount(*shape);
+        state.ResumeTiming();
+        shape->SplitTrianglesIn4();
+    }
+    state.counters["faces"] = (double)faces;
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+BENCHMARK(BM_SplitTrianglesIn4)->Arg(0)->Arg(2)->Arg(5)->Unit(benchmark::kMillisecond);
+
+static void BM_TriangulateNGon(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ShapePtr shape = CreatePrism((int)state.range(0));
+        state.ResumeTiming();
+        shape->Triangulate();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TriangulateNGon)->Arg(16)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void BM_HullCopy(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(0));
+    const HullPtr& hull = *shape->GetHulls().begin();
+    for (auto _ : state)
+    {
+        Shape copy;
+        benchmark::DoNotOptimize(hull->Copy(copy));
+    }
+    state.SetItemsProcessed(state.iterations() * hull->GetFaces().size());
+}
+BENCHMARK(BM_HullCopy)->Arg(2)->Arg(5)->Unit(benchmark::kMillisecond);
+
+static void BM_Store(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(1));
+    const Shape::StorageMode mode = (Shape::StorageMode)state.range(0);
+    for (auto _ : state)
+    {
+        SQLite::DB db;
+        db.Open(":memory:", false);
+        shape->Store(db, mode);
+    }
+    state.SetItemsProcessed(state.iterations() * FaceCount(*shape));
+}
+BENCHMARK(BM_Store)->ArgNames({ "mode", "splits" })
+    ->Args({ (int)Shape::StorageMode::Rows, 5 })
+    ->Args({ (int)Shape::StorageMode::BulkRows, 5 })
+    ->Args({ (int)Shape::StorageMode::Blobs, 5 })
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_Retrieve(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(1));
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    shape->Store(db, (Shape::StorageMode)state.range(0));
+    for (auto _ : state)
+    {
+        Shape retrieved;
+        retrieved.Retrieve(db);
+    }
+    state.SetItemsProcessed(state.iterations() * FaceCount(*shape));
+}
+BENCHMARK(BM_Retrieve)->ArgNames({ "mode", "splits" })
+    ->Args({ (int)Shape::StorageMode::Rows, 5 })
+    ->Args({ (int)Shape::StorageMode::Blobs, 5 })
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateVolume(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(shape->CalculateVolume());
+    }
+    state.SetItemsProcessed(state.iterations() * FaceCount(*shape));
+}
+BENCHMARK(BM_CalculateVolume)->Arg(2)->Arg(5)->Unit(benchmark::kMicrosecond);
+
+static void BM_CalculateBoundingShape(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(1));
+    const HullPtr& hull = *shape->GetHulls().begin();
+    const BoundingShape3d::Type type = (BoundingShape3d::Type)state.range(0);
+    const BoundingShape3d::Accuracy accuracy = (BoundingShape3d::Accuracy)state.range(2);
+    for (auto _ : state)
+    {
+        hull->CalculateBoundingShape(type, accuracy);
+        benchmark::DoNotOptimize(hull->GetBoundingShape());
+    }
+    const auto& vertices = hull->GetVertices();
+    state.SetItemsProcessed(state.iterations() * vertices.size());
+    if (type == BoundingShape3d::Type::Ball && accuracy == BoundingShape3d::Accuracy::Approximate)
+    {
+        state.counters["tightness"] = BoundingShape3d::BallTightness(vertices.begin(), vertices.end());
+    }
+}
+BENCHMARK(BM_CalculateBoundingShape)->ArgNames({ "type", "splits", "accuracy" })
+    ->Args({ (int)BoundingShape3d::Type::Ball, 2, (int)BoundingShape3d::Accuracy::Exact })
+    ->Args({ (int)BoundingShape3d::Type::Ball, 5, (int)BoundingShape3d::Accuracy::Exact })
+    ->Args({ (int)BoundingShape3d::Type::Ball, 2, (int)BoundingShape3d::Accuracy::Approximate })
+    ->Args({ (int)BoundingShape3d::Type::Ball, 5, (int)BoundingShape3d::Accuracy::Approximate })
+    ->Args({ (int)BoundingShape3d::Type::Box, 2, (int)BoundingShape3d::Accuracy::Exact })
+    ->Args({ (int)BoundingShape3d::Type::Box, 5, (int)BoundingShape3d::Accuracy::Exact })
+    ->Args({ (int)BoundingShape3d::Type::OrientedBox, 2, (int)BoundingShape3d::Accuracy::Exact })
+    ->Args({ (int)BoundingShape3d::Type::OrientedBox, 5, (int)BoundingShape3d::Accuracy::Exact })
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_TouchesScalar(benchmark::State& state)
+{
+    const std::vector<BoundingShape3d> shapes = RandomBoundingShapes((size_t)state.range(0));
+    const BoundingShape3d query(Vector3d(0, 0, 0), 10.0);
+    std::vector<BoundingShapeBatch::index_type> indices;
+    for (auto _ : state)
+    {
+        indices.clear();
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            if (query.Touches(shapes[i]))
+            {
+                indices.push_back((BoundingShapeBatch::index_type)i);
+            }
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.counters["hits"] = (double)indices.size();
+    state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(BM_TouchesScalar)->Arg(KernelSize)->Arg(65536);
+
+static void BM_TouchesBatch(benchmark::State& state)
+{
+    BoundingShapeBatch batch;
+    for (const BoundingShape3d& shape : RandomBoundingShapes((size_t)state.range(0)))
+    {
+        batch.Add(shape);
+    }
+    const BoundingShape3d query(Vector3d(0, 0, 0), 10.0);
+    std::vector<BoundingShapeBatch::index_type> indices;
+    for (auto _ : state)
+    {
+        batch.Touches(query, indices);
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.counters["hits"] = (double)indices.size();
+    state.SetItemsProcessed(state.iterations() * batch.GetSize());
+}
+BENCHMARK(BM_TouchesBatch)->Arg(KernelSize)->Arg(65536);
+
+static void BM_QuaternionTransform(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Quat rotation = RandomRotations(1).front();
+    std::vector<Vector3d> result(vectors.size());
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < vectors.size(); ++i)
+        {
+            result[i] = rotation.Transform(vectors[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * vectors.size());
+}
+BENCHMARK(BM_QuaternionTransform);
+
+static void BM_QuaternionTransformBatch(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Quat rotation = RandomRotations(1).front();
+    std::vector<Vector3d> result(vectors.size());
+    for (auto _ : state)
+    {
+        rotation.Transform(vectors.data(), vectors.size(), result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * vectors.size());
+}
+BENCHMARK(BM_QuaternionTransformBatch);
+
+static void BM_RotateHull(benchmark::State& state)
+{
+    ShapePtr shape = CreateDodecahedron((int)state.range(0));
+    const Quat rotation = RandomRotations(1).front();
+    for (auto _ : state)
+    {
+        shape->Rotate(rotation);
+    }
+}
+BENCHMARK(BM_RotateHull)->Arg(5)->Unit(benchmark::kMillisecond);
+
+static void BM_QuaternionMultiply(benchmark::State& state)
+{
+    const std::vector<Quat> rotations = RandomRotations(KernelSize);
+    for (auto _ : state)
+    {
+        Quat q;
+        for (const Quat& rotation : rotations)
+        {
+            q = rotation * q;
+        }
+        benchmark::DoNotOptimize(q);
+    }
+    state.SetItemsProcessed(state.iterations() * rotations.size());
+}
+BENCHMARK(BM_QuaternionMultiply);
+
+static void BM_VectorCrossProduct(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize + 1);
+    std::vector<Vector3d> result(KernelSize);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < KernelSize; ++i)
+        {
+            result[i] = CrossProduct(vectors[i], vectors[i + 1]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_VectorCrossProduct);
+
+static void BM_VectorNormalize(benchmark::State& state)
+{
+    std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    for (Vector3d& v : vectors)
+    {
+        v *= 3.0;
+    }
+    std::vector<Vector3d> result(KernelSize);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < KernelSize; ++i)
+        {
+            result[i] = vectors[i].Normalized();
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_VectorNormalize);
+
+// VectorBatch against the generic TVector loop it replaces
+static void BM_DistancesSquaredGeneric(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Vector3d point(0.5, -0.25, 0.125);
+    std::vector<double> result(KernelSize);
+    for (auto _ : state)
+    {
+        VectorBatch::DistancesSquared<double, 3>(vectors.data(), vectors.size(), point, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_DistancesSquaredGeneric);
+
+static void BM_DistancesSquaredBatch(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Vector3d point(0.5, -0.25, 0.125);
+    std::vector<double> result(KernelSize);
+    for (auto _ : state)
+    {
+        VectorBatch::DistancesSquared(vectors.data(), vectors.size(), point, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_DistancesSquaredBatch);
+
+static void BM_InnerProductsGeneric(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Vector3d direction(0.5, -0.25, 0.125);
+    std::vector<double> result(KernelSize);
+    for (auto _ : state)
+    {
+        VectorBatch::InnerProducts<double, 3>(vectors.data(), vectors.size(), direction, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_InnerProductsGeneric);
+
+static void BM_InnerProductsBatch(benchmark::State& state)
+{
+    const std::vector<Vector3d> vectors = RandomVectors(KernelSize);
+    const Vector3d direction(0.5, -0.25, 0.125);
+    std::vector<double> result(KernelSize);
+    for (auto _ : state)
+    {
+        VectorBatch::InnerProducts(vectors.data(), vectors.size(), direction, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * KernelSize);
+}
+BENCHMARK(BM_InnerProductsBatch);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,315 @@
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BOUNDINGSHAPEBATCH_SSE2
+#endif
+using namespace std;
+
+#include "Geometry.h"
+using namespace Geometry;
+
+namespace
+{
+    // box and radius of a bounding shape; false for an uninitialized one
+    bool GetRoundedBox(const BoundingShape3d& boundingShape, double min[3], double max[3], double& radius)
+    {
+        switch (boundingShape.GetType())
+        {
+        default:
+            return false;
+        case BoundingShape3d::Type::Ball:
+            {
+                const Vector3d center = boundingShape.GetCenter();
+                for (int i = 0; i < 3; ++i)
+                {
+                    min[i] = max[i] = center[i];
+                }
+                radius = boundingShape.GetRadius();
+            }
+            return true;
+        case BoundingShape3d::Type::OrientedBox:
+            {
+                BoundingShape3d box = boundingShape;
+                box.Convert(BoundingShape3d::Type::Box);
+                return GetRoundedBox(box, min, max, radius);
+            }
+        case BoundingShape3d::Type::Box:
+            {
+                const Vector3d vmin = boundingShape.GetMin();
+                const Vector3d vmax = boundingShape.GetMax();
+                for (int i = 0; i < 3; ++i)
+                {
+                    min[i] = vmin[i];
+                    max[i] = vmax[i];
+                }
+                radius = 0;
+            }
+            return true;
+        }
+    }
+
+    bool TestBit(const std::vector<uint64_t>& mask, const size_t index)
+    {
+        return 0 != (mask[index / 64] & (1ull << (index % 64)));
+    }
+}
+
+BoundingShapeBatch::BoundingShapeBatch()
+    : m_size(0)
+{}
+
+void BoundingShapeBatch::Clear()
+{
+    m_size = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        m_min[i].clear();
+        m_max[i].clear();
+    }
+    m_radius.clear();
+    m_orientedBoxes.clear();
+}
+
+void BoundingShapeBatch::Reserve(const size_t count)
+{
+    const size_t padded = (count + BlockSize - 1) / BlockSize * BlockSize;
+    for (int i = 0; i < 3; ++i)
+    {
+        m_min[i].reserve(padded);
+        m_max[i].reserve(padded);
+    }
+    m_radius.reserve(padded);
+}
+
+BoundingShapeBatch::index_type BoundingShapeBatch::Add(const BoundingShape3d& boundingShape)
+{
+    if (m_size == m_radius.size())
+    {
+        // a new block of entries which don't touch anything: the distance to an empty box is infinite
+        const double infinity = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < 3; ++i)
+        {
+            m_min[i].resize(m_size + BlockSize, infinity);
+            m_max[i].resize(m_size + BlockSize, -infinity);
+        }
+        m_radius.resize(m_size + BlockSize, 0);
+    }
+    SetEntry(m_size, boundingShape);
+    return (index_type)m_size++;
+}
+
+void BoundingShapeBatch::Set(const index_type index, const BoundingShape3d& boundingShape)
+{
+    if (index >= m_size)
+    {
+        throw std::runtime_error("Invalid bounding shape index");
+    }
+    SetEntry(index, boundingShape);
+}
+
+void BoundingShapeBatch::SetEntry(const size_t index, const BoundingShape3d& boundingShape)
+{
+    double min[3], max[3], radius;
+    if (!GetRoundedBox(boundingShape, min, max, radius))
+    {
+        min[0] = min[1] = min[2] = std::numeric_limits<double>::infinity();
+        max[0] = max[1] = max[2] = -std::numeric_limits<double>::infinity();
+        radius = 0;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        m_min[i][index] = min[i];
+        m_max[i][index] = max[i];
+    }
+    m_radius[index] = radius;
+
+    auto oriented = std::lower_bound(m_orientedBoxes.begin(), m_orientedBoxes.end(), (index_type)index, [](const std::pair<index_type, BoundingShape3d>& entry, const index_type index) { return entry.first < index; });
+    const bool found = oriented != m_orientedBoxes.end() && oriented->first == index;
+    if (boundingShape.GetType() == BoundingShape3d::Type::OrientedBox)
+    {
+        if (found)
+        {
+            oriented->second = boundingShape;
+        }
+        else
+        {
+            m_orientedBoxes.emplace(oriented, (index_type)index, boundingShape);
+        }
+    }
+    else if (found)
+    {
+        m_orientedBoxes.erase(oriented);
+    }
+}
+
+void BoundingShapeBatch::Touches(const double min[3], const double max[3], const double radius, std::vector<uint64_t>& mask) const
+{
+    GEOMETRY_PROFILE_SCOPE("BoundingShapeBatch::Touches");
+    GEOMETRY_PROFILE_ELEMENTS(m_size);
+    mask.assign(m_radius.size() / BlockSize, 0);
+    const double* const emin[3] = { m_min[0].data(), m_min[1].data(), m_min[2].data() };
+    const double* const emax[3] = { m_max[0].data(), m_max[1].data(), m_max[2].data() };
+    const double* const eradius = m_radius.data();
+    for (size_t block = 0; block < mask.size(); ++block)
+    {
+        const size_t begin = block * BlockSize;
+        uint64_t word = 0;
+#ifdef __AVX__
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d qradius = _mm256_set1_pd(radius);
+        __m256d qmin[3], qmax[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            qmin[i] = _mm256_set1_pd(min[i]);
+            qmax[i] = _mm256_set1_pd(max[i]);
+        }
+        for (size_t j = 0; j < BlockSize; j += 4)
+        {
+            __m256d d2 = zero;
+            for (int i = 0; i < 3; ++i)
+            {
+                // distance between the intervals along axis i
+                const __m256d d = _mm256_max_pd(zero, _mm256_max_pd(_mm256_sub_pd(qmin[i], _mm256_loadu_pd(emax[i] + begin + j)), _mm256_sub_pd(_mm256_loadu_pd(emin[i] + begin + j), qmax[i])));
+                d2 = _mm256_add_pd(d2, _mm256_mul_pd(d, d));
+            }
+            const __m256d s = _mm256_add_pd(qradius, _mm256_loadu_pd(eradius + begin + j));
+            const int hits = _mm256_movemask_pd(_mm256_cmp_pd(d2, _mm256_mul_pd(s, s), _CMP_LE_OQ));
+            word |= (uint64_t)hits << j;
+        }
+#elif defined(BOUNDINGSHAPEBATCH_SSE2)
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d qradius = _mm_set1_pd(radius);
+        __m128d qmin[3], qmax[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            qmin[i] = _mm_set1_pd(min[i]);
+            qmax[i] = _mm_set1_pd(max[i]);
+        }
+        for (size_t j = 0; j < BlockSize; j += 2)
+        {
+            __m128d d2 = zero;
+            for (int i = 0; i < 3; ++i)
+            {
+                const __m128d d = _mm_max_pd(zero, _mm_max_pd(_mm_sub_pd(qmin[i], _mm_loadu_pd(emax[i] + begin + j)), _mm_sub_pd(_mm_loadu_pd(emin[i] + begin + j), qmax[i])));
+                d2 = _mm_add_pd(d2, _mm_mul_pd(d, d));
+            }
+            const __m128d s = _mm_add_pd(qradius, _mm_loadu_pd(eradius + begin + j));
+            const int hits = _mm_movemask_pd(_mm_cmple_pd(d2, _mm_mul_pd(s, s)));
+            word |= (uint64_t)hits << j;
+        }
+#else
+        // branch free, so the compiler can vectorize it
+        unsigned char hits[BlockSize];
+        for (size_t j = 0; j < BlockSize; ++j)
+        {
+            const size_t e = begin + j;
+            double d2 = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const double d = std::max(0.0, std::max(min[i] - emax[i][e], emin[i][e] - max[i]));
+                d2 += d * d;
+            }
+            const double s = radius + eradius[e];
+            hits[j] = d2 <= s * s ? 1 : 0;
+        }
+        for (size_t j = 0; j < BlockSize; ++j)
+        {
+            word |= (uint64_t)hits[j] << j;
+        }
+#endif
+        mask[block] = word;
+    }
+}
+
+void BoundingShapeBatch::Touches(const BoundingShape3d& query, std::vector<uint64_t>& mask) const
+{
+    double min[3], max[3], radius;
+    if (!GetRoundedBox(query, min, max, radius))
+    {
+        mask.assign(m_radius.size() / BlockSize, 0);
+        return;
+    }
+    Touches(min, max, radius, mask);
+
+    // the oriented boxes were tested on their enclosing boxes
+    auto Refine = [&mask, &query](const size_t index, const BoundingShape3d& boundingShape)
+    {
+        if (TestBit(mask, index) && !query.Touches(boundingShape))
+        {
+            mask[index / 64] &= ~(1ull << (index % 64));
+        }
+    };
+    if (query.GetType() == BoundingShape3d::Type::OrientedBox)
+    {
+        std::vector<index_type> candidates;
+        GetIndices(mask, candidates);
+        auto oriented = m_orientedBoxes.begin();
+        for (const index_type index : candidates)
+        {
+            while (oriented != m_orientedBoxes.end() && oriented->first < index)
+            {
+                ++oriented;
+            }
+            if (oriented != m_orientedBoxes.end() && oriented->first == index)
+            {
+                Refine(index, oriented->second);
+            }
+            else
+            {
+                double emin[3], emax[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    emin[i] = m_min[i][index];
+                    emax[i] = m_max[i][index];
+                }
+                if (m_radius[index] > 0)
+                {
+                    Refine(index, BoundingShape3d(Vector3d(emin[0], emin[1], emin[2]), m_radius[index]));
+                }
+                else
+                {
+                    Refine(index, BoundingShape3d(Vector3d(emin[0], emin[1], emin[2]), Vector3d(emax[0], emax[1], emax[2])));
+                }
+            }
+        }
+    }
+    else
+    {
+        for (const auto& oriented : m_orientedBoxes)
+        {
+            Refine(oriented.first, oriented.second);
+        }
+    }
+}
+
+void BoundingShapeBatch::Touches(const BoundingShape3d& query, std::vector<index_type>& indices) const
+{
+    std::vector<uint64_t> mask;
+    Touches(query, mask);
+    GetIndices(mask, indices);
+}
+
+void BoundingShapeBatch::Encapsulates(const Vector3d& point, std::vector<index_type>& indices) const
+{
+    // a point is inside if it touches the bounding shape
+    Touches(BoundingShape3d(point, 0.0), indices);
+}
+
+void BoundingShapeBatch::GetIndices(const std::vector<uint64_t>& mask, std::vector<index_type>& indices)
+{
+    indices.clear();
+    for (size_t block = 0; block < mask.size(); ++block)
+    {
+        for (uint64_t word = mask[block]; word != 0; word &= word - 1)
+        {
+            // index of the lowest set bit
+            index_type bit = 0;
+            for (uint64_t lowest = word & (~word + 1); lowest > 1; lowest >>= 1)
+            {
+                ++bit;
+            }
+            indices.push_back((index_type)(block * 64) + bit);
+        }
+    }
+}
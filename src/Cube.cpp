@@ -70,9 +70,9 @@ Cube::Cube()
     hull->CalculateBoundingShape(BoundingShape3d::Type::Box);
 
     // create face normals
-    ForEachFace([](const FaceRaw& face) {face->CalcNormal(); });
+    ForEachHull([](const HullRaw& hull) {hull->UpdateNormals(); });
 
     // check geometric integrity
-    ForEachFace([](const FaceRaw& face) {face->CheckPointering(); });
+    assert(Validate().IsValid());
 }
 
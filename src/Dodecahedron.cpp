@@ -39,11 +39,11 @@ Dodecahedron::Dodecahedron(const int initialFaceCount)
     }
 
     // rotate vertices so that I ends up being 0,0,1
-    Quat q(*I, Vertex(0, 1, 0));
+    Quat q(Vector3d(*I), Vector3d(0, 1, 0));
     RotationMatrix3d rot(q);
     for (auto v : vertices)
     {
-        *v = rot.Transform(*v);
+        *v = Vertex(rot.Transform(Vector3d(*v)));
     }
 
     // create the hull
@@ -126,7 +126,7 @@ Dodecahedron::Dodecahedron(const int initialFaceCount)
     Join(RD, DR);
 
     // check geometric integrity
-    ForEachFace([](const FaceRaw& face) {face->CheckPointering(); });
+    assert(Validate().IsValid());
 
     // fill bounding shape
     hull->CalculateBoundingShape();
@@ -180,8 +180,8 @@ void Dodecahedron::InitialRefinement()
         }
         hull->RemoveFace(face);
     }
-    ForEachFace([](const FaceRaw& face) {face->CalcNormal(); });
-    ForEachFace([](const FaceRaw& face) {face->CheckPointering(); });
+    ForEachHull([](const HullRaw& hull) {hull->UpdateNormals(); });
+    assert(Validate().IsValid());
 }
 
 void Dodecahedron::Refine(int initialFaceCount)
@@ -212,20 +212,14 @@ void Dodecahedron::Refine(int initialFaceCount)
         // triangles only, required in order to reallign vertices to sphere
         Triangulate();
     }
-    // move all vertices to the sphere (dist 1.0 from origin) and correct the face normals
+    // move all vertices to the sphere (dist 1.0 from origin), correct the face normals and give the vertices
+    // smooth normals
     ForEachVertex([](const VertexRaw& vertex) {vertex->Normalize(); });
-    ForEachFace([](const FaceRaw& face) {face->CalcNormal(); });
-
-    // create perfect sphere edge normals
-    //ForEachEdge([&](const EdgeRaw& edge)
-    //{
-    //    // give all edges at this vertex the same normal
-    //    if (!edge->GetStartNormal())
-    //    {
-    //        NormalPtr normal = Construct<Normal>(*edge->GetStartVertex());
-    //        edge->ForEachEdgeAtStartVertex([normal](const EdgeRaw& edge) {edge->SetStartNormal(normal); });
-    //    }
-    //});
+    ParallelForEachHull([](const HullRaw& hull)
+    {
+        hull->InvalidateNormals();
+        hull->UpdateNormals(Hull::VertexNormals::AreaWeighted);
+    });
 }
 
 
@@ -5,9 +5,32 @@ using namespace Geometry;
 Face::~Face()
 {}
 
+const EdgePtr& Face::AddEdge(EdgePtr& edge)
+{
+    if (m_hull)
+    {
+        m_hull->Materialize();
+    }
+    return *m_edges.emplace(edge).first;
+}
+
+void Face::RemoveEdge(EdgePtr& edge)
+{
+    if (m_hull)
+    {
+        m_hull->Materialize();
+    }
+    m_edges.erase(edge);
+}
+
 void Face::CalcNormal()
 {
     CheckPointering();
+    UpdateNormal(CalculateNormal());
+}
+
+Normal Face::CalculateNormal() const
+{
     Normal normal(0, 0, 0);
     VertexRaw p0 = (*m_edges.begin())->GetPrev()->GetStartVertex();
     ForEachVertex([&normal,&p0](const VertexRaw& p1)
@@ -16,7 +39,20 @@ void Face::CalcNormal()
         p0 = p1;
     });
     double surface = normal.Length();
-    m_normal = Construct<Normal>(normal / surface);
+    return normal / surface;
+}
+
+void Face::UpdateNormal(const Normal& normal)
+{
+    if (m_normal && m_normal.use_count() == 1)
+    {
+        *m_normal = normal;
+    }
+    else
+    {
+        m_normal = Construct<Normal>(normal);
+    }
+    m_normalOutdated = false;
 }
 
 const std::vector<EdgeRaw> Face::GetEdgesOrdered() const
@@ -45,33 +81,34 @@ private:
     // return two strips which connect the 'extreme' points
     std::pair<std::pair<EdgeRaw,int>, std::pair<EdgeRaw,int>> FindExtremeVertices(bool AllowNeighbors)
     {
-        std::vector<std::pair<VertexPtr, EdgeRaw>> edges;
+        std::vector<EdgeRaw> edges;
+        std::vector<Vertex> vertices;
         m_face->ForEachEdge([&](const EdgeRaw& edge)
         {
-            edges.emplace_back(edge->GetStartVertex(),edge);
+            edges.emplace_back(edge);
+            vertices.emplace_back(*edge->GetStartVertex());
         });
         double dist = -1;
         int index0 = -1;
         int index1 = -1;
         // find the 2 vertices furthest apart
         size_t offset = AllowNeighbors ? 0 : 1;
-        for (size_t i = 0; i<edges.size() - offset; ++i)
+        for (size_t i = 0; i + 1 + offset < edges.size(); ++i)
         {
-            for (size_t j = i + 1 + offset; j<edges.size(); ++j)
+            const size_t first = i + 1 + offset;
+            const size_t j = first + VectorBatch::Farthest(vertices.data() + first, vertices.size() - first, vertices[i]);
+            double l = DistanceSquared(vertices[j], vertices[i]);
+            if (l > dist)
             {
-                double l = DistanceSquared(*edges[j].first, *edges[i].first);
-                if (l > dist)
-                {
-                    index0 = (int)i;
-                    index1 = (int)j;
-                    dist = l;
-                }
+                index0 = (int)i;
+                index1 = (int)j;
+                dist = l;
             }
         }
         assert(index0 != -1 && index1 != -1);
         return std::make_pair(
-            std::make_pair(edges[index0].second, index1 - index0), 
-            std::make_pair(edges[index1].second, (int)edges.size() - (index1 - index0)));
+            std::make_pair(edges[index0], index1 - index0), 
+            std::make_pair(edges[index1], (int)edges.size() - (index1 - index0)));
     }
 
     std::pair<FacePtr, FacePtr> SplitCore(bool AddVertices = true)
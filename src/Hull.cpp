@@ -1,16 +1,227 @@
 #include "Geometry.h"
+#include "Parallel.h"
 using namespace std;
 using namespace Geometry;
 
 HullPtr Hull::Copy(Shape& newShape) const
 {
-    ForEachFace([](const FaceRaw& face) { face->CheckPointering(); });
+    GEOMETRY_PROFILE_SCOPE("Hull::Copy");
+    GEOMETRY_PROFILE_ELEMENTS(GetFaces().size());
+    HullPtr newHull = newShape.ConstructAndAddHull();
+    newHull->SetOrientation(GetOrientation());
+    newHull->SetBoundingShape(GetBoundingShape());
+    newHull->SetColor(GetColor());
+    newHull->SetRenderMode(GetRenderMode());
+    newHull->CopyFaces(*this);
+    if (IsInstance())
+    {
+        newHull->ApplyTransform(m_transform);
+    }
+    return newHull;
+}
+
+HullPtr Hull::Instance(Shape& newShape)
+{
+    Load();
+    // instances of an instance share the same faces
+    HullPtr geometry = GetGeometry();
+    if (!geometry)
+    {
+        geometry = shared_from_this();
+    }
 
     HullPtr newHull = newShape.ConstructAndAddHull();
     newHull->SetOrientation(GetOrientation());
     newHull->SetBoundingShape(GetBoundingShape());
     newHull->SetColor(GetColor());
     newHull->SetRenderMode(GetRenderMode());
+    newHull->m_geometry = geometry;
+    newHull->m_transform = m_transform;
+
+    std::lock_guard<std::mutex> lock(geometry->m_instancesMutex);
+    auto& instances = geometry->m_instances;
+    instances.erase(std::remove_if(instances.begin(), instances.end(), [](const std::weak_ptr<Hull>& instance) { return instance.expired(); }), instances.end());
+    instances.emplace_back(newHull);
+    geometry->m_hasInstances = true;
+    return newHull;
+}
+
+void Hull::SetLoader(const Loader& loader)
+{
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+    m_loader = loader;
+    m_loadPending = (bool)loader;
+}
+
+void Hull::LoadNow()
+{
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+    if (!m_loadPending)
+    {
+        // loaded by another thread meanwhile
+        return;
+    }
+    Shape loaded;
+    m_loader(loaded);
+    if (loaded.GetHulls().size() != 1)
+    {
+        throw std::runtime_error("Hull loader didn't produce a single hull");
+    }
+    const HullPtr& hull = *loaded.GetHulls().begin();
+    m_faces.swap(hull->m_faces);
+    for (const FacePtr& face : m_faces)
+    {
+        face->SetHull(this);
+    }
+    m_loader = nullptr;
+    m_loadPending = false;
+}
+
+void Hull::DetachInstances()
+{
+    if (!m_hasInstances)
+    {
+        return;
+    }
+    std::vector<std::weak_ptr<Hull>> instances;
+    {
+        std::lock_guard<std::mutex> lock(m_instancesMutex);
+        instances.swap(m_instances);
+        m_hasInstances = false;
+    }
+    for (const std::weak_ptr<Hull>& weak : instances)
+    {
+        // instances which materialized meanwhile don't share the faces anymore
+        const HullPtr instance = weak.lock();
+        if (instance)
+        {
+            instance->MaterializeFrom(this);
+        }
+    }
+}
+
+void Hull::Materialize()
+{
+    Load();
+    DetachInstances();
+    MaterializeFrom(nullptr);
+}
+
+std::unordered_map<FaceRaw, FacePtr> Hull::MaterializeFrom(const Hull* shared)
+{
+    // m_geometry is only changed under this lock; readers see either the shared faces or the completed private copy
+    std::lock_guard<std::mutex> lock(m_materializeMutex);
+    std::unordered_map<FaceRaw, FacePtr> copies;
+    const HullPtr geometry = m_geometry;
+    if (!geometry || (shared && shared != geometry.get()))
+    {
+        return copies;
+    }
+    if (geometry.use_count() == 2)
+    {
+        // last user of the geometry, take it over
+        m_faces.swap(geometry->m_faces);
+        for (const FacePtr& face : m_faces)
+        {
+            face->SetHull(this);
+        }
+    }
+    else
+    {
+        copies = CopyFaces(*geometry);
+    }
+    if (!m_transform.IsIdentity())
+    {
+        ApplyTransform(m_transform);
+    }
+    std::atomic_store(&m_geometry, HullPtr());
+    m_transform = InstanceTransform();
+    Invalidate();
+    return copies;
+}
+
+void Hull::RemoveFace(const FacePtr& face)
+{
+    Load();
+    DetachInstances();
+    const auto copies = MaterializeFrom(nullptr);
+    const auto copy = copies.find(face);
+    MarkModified();
+    m_faces.erase(copies.end() == copy ? face : copy->second);
+}
+
+double Hull::ApplyTransform(const InstanceTransform& transform)
+{
+    const double scale = transform.GetScale();
+    const Quat& rotation = transform.GetRotation();
+    const Vector3d& translation = transform.GetTranslation();
+    const bool rotate = !(rotation == Quat());
+    // the vertices and normals are gathered in arrays, so the rotation is converted to a matrix once and applied in batches.
+    // They are taken from m_faces: while an instance is materialized, GetFaces() still returns the shared faces.
+    std::unordered_set<VertexRaw> uniqueVertices;
+    std::unordered_set<NormalRaw> uniqueNormals;
+    for (const FacePtr& face : m_faces)
+    {
+        if (rotate)
+        {
+            uniqueNormals.emplace(face->GetNormal());
+        }
+        face->ForEachEdge([&](const EdgeRaw& edge)
+        {
+            uniqueVertices.emplace(edge->GetStartVertex());
+            if (rotate)
+            {
+                uniqueNormals.emplace(edge->GetStartNormal());
+            }
+        });
+    }
+    std::vector<VertexRaw> vertices;
+    std::vector<Vector3d> points;
+    vertices.reserve(uniqueVertices.size());
+    points.reserve(uniqueVertices.size());
+    for (const VertexRaw& vertex : uniqueVertices)
+    {
+        vertices.emplace_back(vertex);
+        points.emplace_back(Vector3d(*vertex) * scale);
+    }
+    if (rotate)
+    {
+        rotation.Transform(points.data(), points.size(), points.data());
+    }
+    double rounding = 0;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vector3d v = points[i] + translation;
+        (*vertices[i]) = Vertex(v);
+        if (!std::is_same<Vertex, Vector3d>::value)
+        {
+            rounding = std::max(rounding, Distance(v, Vector3d(*vertices[i])));
+        }
+    }
+    if (rotate)
+    {
+        std::vector<NormalRaw> normals;
+        std::vector<Vector3d> directions;
+        for (const NormalRaw& normal : uniqueNormals)
+        {
+            if (normal)
+            {
+                normals.emplace_back(normal);
+                directions.emplace_back(*normal);
+            }
+        }
+        rotation.Transform(directions.data(), directions.size(), directions.data());
+        for (size_t i = 0; i < normals.size(); ++i)
+        {
+            (*normals[i]) = Normal(directions[i]);
+        }
+    }
+    return rounding;
+}
+
+std::unordered_map<FaceRaw, FacePtr> Hull::CopyFaces(const Hull& other)
+{
+    assert(other.Validate().IsValid());
 
     std::unordered_map<FaceRaw, FacePtr> faces;
     std::unordered_map<EdgeRaw, EdgePtr> edges;
@@ -20,8 +231,7 @@ HullPtr Hull::Copy(Shape& newShape) const
     std::unordered_map<TextureCoordRaw, TextureCoordPtr> textureCoordinates;
 
     // create a new instance for each existing patch, face, edge, vertex, normal, color and texturecoordinate
-    colors.emplace(GetColor(), nullptr);
-    ForEachFace([&](const FaceRaw& face)
+    other.ForEachFace([&](const FaceRaw& face)
     {
         normals.emplace(face->GetNormal(), nullptr);
         colors.emplace(face->GetColor(), nullptr);
@@ -52,10 +262,11 @@ HullPtr Hull::Copy(Shape& newShape) const
     {
         textureCoordinateMap.second = textureCoordinateMap.first == nullptr ? nullptr : Construct<TextureCoord>(*textureCoordinateMap.first);
     }
-    // recreate complex structures
+    // recreate complex structures; the faces join this hull once they are complete, filling them doesn't modify it
     for (auto& faceMap : faces)
     {
-        faceMap.second = newHull->ConstructAndAddFace();
+        faceMap.second = Construct<Face>(HullRaw());
+        m_faces.emplace(faceMap.second);
     }
     for (auto& edgeMap : edges)
     {
@@ -80,23 +291,28 @@ HullPtr Hull::Copy(Shape& newShape) const
         assert(faceMap.first->GetEdgeCount() == faceMap.second->GetEdgeCount());
         assert(faceMap.second->GetStartEdge() != nullptr);
         faceMap.second->SetNormal(normals[faceMap.first->GetNormal()]);
+        if (faceMap.first->IsNormalOutdated())
+        {
+            faceMap.second->InvalidateNormal();
+        }
         faceMap.second->SetColor(colors[faceMap.first->GetColor()]);
+        faceMap.second->SetHull(this);
     }
-    newHull->ForEachFace([](const FaceRaw& face) { face->CheckPointering(); });
-    return newHull;
+    assert(Validate().IsValid());
+    return faces;
 }
 
 void Hull::SplitTrianglesIn4()
 {
-    size_t count = 0;
+    GEOMETRY_PROFILE_SCOPE("Hull::SplitTrianglesIn4");
+    Materialize();
+    MarkModified();
+
+    assert(Validate().IsValid());
     std::vector<FaceRaw> faces;
     std::unordered_set<EdgeRaw> edges;
-    ForEachFace([&count](const FaceRaw& face) 
-    {
-        ++count;
-        face->CheckPointering(); 
-    });
-    faces.reserve(count);
+    faces.reserve(GetFaces().size());
+    GEOMETRY_PROFILE_ELEMENTS(GetFaces().size());
     ForEachFace([&edges,&faces](const FaceRaw& face)
     {
         assert(3==face->GetEdgeCount());
@@ -167,11 +383,9 @@ void Hull::SplitTrianglesIn4()
         f1->AddEdge(e23);
         f2->AddEdge(e34);
         f2->AddEdge(e45);
-        // calculate face normals
-        f0->CalcNormal();
-        f1->CalcNormal();
-        f2->CalcNormal();
-        f3->CalcNormal();
+        // the middle face takes over the normal object of the old face, the normals are calculated by UpdateNormals
+        f3->SetNormal(face->GetNormal());
+        f3->InvalidateNormal();
         // check all faces
         f0->CheckPointering();
         f1->CheckPointering();
@@ -180,26 +394,186 @@ void Hull::SplitTrianglesIn4()
         // remove old face
         RemoveFace(face);
     }
+    UpdateNormals();
 }
 
 void Hull::Triangulate()
 {
+    GEOMETRY_PROFILE_SCOPE("Hull::Triangulate");
+    Materialize();
+    MarkModified();
+
+    assert(Validate().IsValid());
     std::vector<FaceRaw> faces;
     ForEachFace([&faces](const FaceRaw& face) 
     {
         faces.emplace_back(face);
-        face->CheckPointering();
     });
+    GEOMETRY_PROFILE_ELEMENTS(faces.size());
     for (FaceRaw& face : faces)
     {
         face->Triangulate();
     }
 }
 
-void Hull::CalculateBoundingShape(const BoundingShape3d::Type type)
+namespace
 {
+    // weight of the face of edge in the normal of its start vertex: the angle or the area of the corner
+    double CornerWeight(const EdgeRaw& edge, const Hull::VertexNormals vertexNormals)
+    {
+        const Vector3d vertex(*edge->GetStartVertex());
+        const Vector3d next = Vector3d(*edge->GetEndVertex()) - vertex;
+        const Vector3d prev = Vector3d(*edge->GetPrev()->GetStartVertex()) - vertex;
+        const double sine = CrossProduct(next, prev).Length();
+        if (vertexNormals == Hull::VertexNormals::AngleWeighted)
+        {
+            return atan2(sine, next.InnerProduct(prev));
+        }
+        return sine / 2;
+    }
+}
+
+void Hull::UpdateNormals(const VertexNormals vertexNormals)
+{
+    GEOMETRY_PROFILE_SCOPE("Hull::UpdateNormals");
+    const bool smooth = vertexNormals != VertexNormals::None;
+    auto FindFaces = [this, smooth]()
+    {
+        std::vector<FaceRaw> faces;
+        ForEachFace([&faces, smooth](const FaceRaw& face)
+        {
+            bool update = face->IsNormalOutdated();
+            if (!update && smooth)
+            {
+                face->ForEachEdge([&update](const EdgeRaw& edge) { update = update || !edge->GetStartNormal(); });
+            }
+            if (update)
+            {
+                faces.emplace_back(face);
+            }
+        });
+        return faces;
+    };
+    std::vector<FaceRaw> faces = FindFaces();
+    if (faces.empty())
+    {
+        return;
+    }
+    // the normals are part of the (shared) geometry
+    const bool instance = IsInstance();
+    Materialize();
+    if (instance)
+    {
+        faces = FindFaces();
+    }
+    GEOMETRY_PROFILE_ELEMENTS(faces.size());
+    Invalidate();
+
+    // face normals, calculated in parallel into an array
+    std::vector<Normal> normals(faces.size());
+    ParallelFor(faces.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            normals[i] = faces[i]->CalculateNormal();
+        }
+    }, 1024);
+    for (size_t i = 0; i < faces.size(); ++i)
+    {
+        faces[i]->UpdateNormal(normals[i]);
+    }
+    if (!smooth)
+    {
+        return;
+    }
+
+    // vertex normals, one edge per vertex
+    std::vector<EdgeRaw> corners;
+    std::unordered_set<VertexRaw> vertices;
+    for (const FaceRaw& face : faces)
+    {
+        face->ForEachEdge([&](const EdgeRaw& edge)
+        {
+            if (vertices.emplace(edge->GetStartVertex()).second)
+            {
+                corners.emplace_back(edge);
+            }
+        });
+    }
+    normals.resize(corners.size());
+    ParallelFor(corners.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Vector3d sum(0, 0, 0);
+            corners[i]->ForEachEdgeAtStartVertex([&sum, vertexNormals](const EdgeRaw& edge)
+            {
+                const NormalPtr& faceNormal = edge->GetFace()->GetNormal();
+                if (faceNormal)
+                {
+                    sum += Vector3d(*faceNormal) * CornerWeight(edge, vertexNormals);
+                }
+            });
+            normals[i] = Normal(sum.Normalized());
+        }
+    }, 1024);
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        // reuse the normal object of the vertex when only the edges at the vertex refer to it
+        NormalPtr normal = corners[i]->GetStartNormal();
+        long users = 1;
+        corners[i]->ForEachEdgeAtStartVertex([&normal, &users](const EdgeRaw& edge) { users += edge->GetStartNormal() == normal ? 1 : 0; });
+        if (normal && normal.use_count() == users)
+        {
+            *normal = normals[i];
+        }
+        else
+        {
+            normal = Construct<Normal>(normals[i]);
+        }
+        corners[i]->ForEachEdgeAtStartVertex([&normal](const EdgeRaw& edge) { edge->SetStartNormal(normal); });
+    }
+}
+
+void Hull::InvalidateNormals()
+{
+    Materialize();
+    ForEachFace([](const FaceRaw& face) { face->InvalidateNormal(); });
+}
+
+void Hull::CalculateBoundingShape(const BoundingShape3d::Type type, const BoundingShape3d::Accuracy accuracy)
+{
+    GEOMETRY_PROFILE_SCOPE("Hull::CalculateBoundingShape");
+    MarkModified();
+    if (!IsInstance() && (type == BoundingShape3d::Type::Box || accuracy == BoundingShape3d::Accuracy::Approximate))
+    {
+        // duplicates don't change these, so skip the (expensive) deduplication of GetVertices
+        std::vector<VertexRaw> vertices;
+        ForEachFace([&vertices](const FaceRaw& face)
+        {
+            face->ForEachVertex([&vertices](const VertexRaw& vertex) { vertices.emplace_back(vertex); });
+        });
+        GEOMETRY_PROFILE_ELEMENTS(vertices.size());
+        m_boundingShape.Set(type, vertices.begin(), vertices.end(), accuracy);
+        return;
+    }
     const auto& vertices = GetVertices();
-    m_boundingShape.Set(type, vertices.begin(), vertices.end());
+    GEOMETRY_PROFILE_ELEMENTS(vertices.size());
+    if (IsInstance())
+    {
+        // bounding shape in shape coordinates; transform copies of the shared vertices
+        std::vector<VertexPtr> transformed;
+        transformed.reserve(vertices.size());
+        for (const VertexRaw& vertex : vertices)
+        {
+            transformed.emplace_back(Construct<Vertex>(m_transform.GetRotation().Transform(Vector3d(*vertex) * m_transform.GetScale()) + m_transform.GetTranslation()));
+        }
+        m_boundingShape.Set(type, transformed.begin(), transformed.end(), accuracy);
+    }
+    else
+    {
+        m_boundingShape.Set(type, vertices.begin(), vertices.end(), accuracy);
+    }
 }
 
 std::unordered_set<VertexRaw> Hull::GetVertices() const
@@ -217,7 +591,7 @@ std::unordered_set<VertexRaw> Hull::GetVertices() const
 
 void Hull::ForEachFace(std::function<void(const FaceRaw& facePtr)> func) const
 {
-    for (const FaceRaw& face : m_faces)
+    for (const FaceRaw& face : GetFaces())
     {
         func(face);
     }
@@ -241,30 +615,197 @@ void Hull::ForEachVertex(std::function<void(const VertexRaw& vertexPtr)> func) c
 
 void Hull::Scale(const double factor)
 {
-    ForEachVertex([factor](const VertexRaw& vertex)
+    m_boundingShape.Scale(factor);
+    if (IsInstance())
     {
-        (*vertex) *= factor;
-    });
+        m_transform.Scale(factor);
+        MarkModified();
+        return;
+    }
+    Materialize();
+    InstanceTransform transform;
+    transform.Scale(factor);
+    m_boundingShape.Grow(ApplyTransform(transform));
+    Invalidate();
 }
 
 void Hull::Translate(const Vector3d& translation)
 {
-    ForEachVertex([translation](const VertexRaw& vertex)
+    m_boundingShape.Translate(translation);
+    if (IsInstance())
     {
-        (*vertex) += translation;
-    });
+        m_transform.Translate(translation);
+        MarkModified();
+        return;
+    }
+    Materialize();
+    InstanceTransform transform;
+    transform.Translate(translation);
+    m_boundingShape.Grow(ApplyTransform(transform));
+    Invalidate();
+}
+
+void Hull::Rotate(const Quat& rotation)
+{
+    m_boundingShape.Rotate(rotation);
+    if (IsInstance())
+    {
+        m_transform.Rotate(rotation);
+        MarkModified();
+        return;
+    }
+    Materialize();
+    InstanceTransform transform;
+    transform.Rotate(rotation);
+    m_boundingShape.Grow(ApplyTransform(transform));
+    Invalidate();
+}
+
+namespace
+{
+    uint64_t Mix(uint64_t x)
+    {
+        // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    uint64_t Hash(const Vertex& vertex)
+    {
+        uint64_t hash = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            // +0.0 turns -0.0 into 0.0, the db doesn't keep the sign of zero
+            const double value = vertex[i] + 0.0;
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            hash = Mix(hash + bits);
+        }
+        return hash;
+    }
+}
+
+void Hull::ValidationReport::Merge(const ValidationReport& other)
+{
+    m_faces += other.m_faces;
+    m_edges += other.m_edges;
+    m_degenerateFaces += other.m_degenerateFaces;
+    m_openRings += other.m_openRings;
+    m_foreignEdges += other.m_foreignEdges;
+    m_foreignFaces += other.m_foreignFaces;
+    m_unpairedTwins += other.m_unpairedTwins;
+    m_nonManifoldEdges += other.m_nonManifoldEdges;
+    m_inconsistentNormals += other.m_inconsistentNormals;
+    m_checksum += other.m_checksum;
+}
+
+std::string Hull::ValidationReport::ToString() const
+{
+    return boost::str(boost::format("%1% faces, %2% edges: %3% degenerate faces, %4% open rings, %5% foreign edges, %6% foreign faces, %7% unpaired twins, %8% non manifold edges, %9% inconsistent normals")
+        % m_faces % m_edges % m_degenerateFaces % m_openRings % m_foreignEdges % m_foreignFaces % m_unpairedTwins % m_nonManifoldEdges % m_inconsistentNormals);
+}
+
+void Hull::ValidationReport::Check(const std::string& what) const
+{
+    if (!IsValid())
+    {
+        throw std::runtime_error(what + ": " + ToString());
+    }
+}
+
+Hull::ValidationReport Hull::Validate() const
+{
+    GEOMETRY_PROFILE_SCOPE("Hull::Validate");
+    const HullPtr geometry = GetGeometry();
+    const HullRaw owner = geometry ? HullRaw(geometry) : HullRaw(const_cast<Hull*>(this));
+    const std::vector<FaceRaw> faces(GetFaces().begin(), GetFaces().end());
+    GEOMETRY_PROFILE_ELEMENTS(faces.size());
+
+    ValidationReport report = {};
+    std::mutex mutex;
+    ParallelFor(faces.size(), [&](size_t begin, size_t end)
+    {
+        ValidationReport part = {};
+        for (size_t i = begin; i < end; ++i)
+        {
+            const FaceRaw& face = faces[i];
+            const size_t edgeCount = face->GetEdgeCount();
+            ++part.m_faces;
+            part.m_edges += edgeCount;
+            part.m_foreignFaces += (face->GetHull() != owner) ? 1 : 0;
+            if (edgeCount < 3)
+            {
+                ++part.m_degenerateFaces;
+                continue;
+            }
+
+            // walk the ring once, at most edgeCount steps
+            const EdgeRaw start = face->GetStartEdge();
+            EdgeRaw edge = start;
+            size_t visited = 0;
+            size_t normals = 0;
+            bool open = false;
+            Normal ringNormal(0, 0, 0);
+            do
+            {
+                const EdgeRaw next = edge->GetNext();
+                if (!next || next->GetPrev() != edge || !edge->GetStartVertex())
+                {
+                    open = true;
+                    break;
+                }
+                if (edge->GetFace() != face || 0 == face->GetEdgesUnordered().count(edge.lock()))
+                {
+                    ++part.m_foreignEdges;
+                }
+                const EdgeRaw twin = edge->GetTwin();
+                if (!twin || twin->GetTwin() != edge)
+                {
+                    ++part.m_unpairedTwins;
+                }
+                else if (twin->GetFace() == face || twin->GetStartVertex() != next->GetStartVertex() || (twin->GetNext() && twin->GetNext()->GetStartVertex() != edge->GetStartVertex()))
+                {
+                    ++part.m_nonManifoldEdges;
+                }
+                normals += edge->GetStartNormal() ? 1 : 0;
+                if (next->GetStartVertex())
+                {
+                    ringNormal += CrossProduct(*edge->GetStartVertex(), *next->GetStartVertex());
+                    part.m_checksum += Mix(Hash(*edge->GetStartVertex()) * 31 + Hash(*next->GetStartVertex()));
+                }
+                edge = next;
+                ++visited;
+            } while (edge != start && visited < edgeCount);
+            if (open || edge != start || visited != edgeCount)
+            {
+                ++part.m_openRings;
+                continue;
+            }
+            if ((normals != 0 && normals != edgeCount) || (face->GetNormal() && face->GetNormal()->InnerProduct(ringNormal) < 0))
+            {
+                ++part.m_inconsistentNormals;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        report.Merge(part);
+    }, 1024);
+    return report;
 }
 
 double Hull::CalculateVolume() const
 {
     auto SignedVolumeOfTriangle = [](const Vertex& v1, const Vertex& v2, const Vertex& v3) 
     {
-        auto v321 = v3[0]*v2[1]*v1[2];
-        auto v231 = v2[0]*v3[1]*v1[2];
-        auto v312 = v3[0]*v1[1]*v2[2];
-        auto v132 = v1[0]*v3[1]*v2[2];
-        auto v213 = v2[0]*v1[1]*v3[2];
-        auto v123 = v1[0]*v2[1]*v3[2];
+        const double v321 = (double)v3[0]*v2[1]*v1[2];
+        const double v231 = (double)v2[0]*v3[1]*v1[2];
+        const double v312 = (double)v3[0]*v1[1]*v2[2];
+        const double v132 = (double)v1[0]*v3[1]*v2[2];
+        const double v213 = (double)v2[0]*v1[1]*v3[2];
+        const double v123 = (double)v1[0]*v2[1]*v3[2];
         return (1.0f / 6.0f)*(-v321 + v231 + v312 - v132 - v213 + v123);
     };
     auto SignedVolumeOfFace = [&SignedVolumeOfTriangle](const Face& face)
@@ -291,7 +832,9 @@ double Hull::CalculateVolume() const
     {
         volume += SignedVolumeOfFace(*facePtr);
     });
-    return fabs(volume);
+    // rotation and translation preserve the volume, scaling does not
+    const double scale = m_transform.GetScale();
+    return fabs(volume) * scale * scale * scale;
 }
 
 // algorithm:
@@ -458,6 +1001,10 @@ private:
 
 HullPtr Hull::Add(HullPtr & other)
 {
+    GEOMETRY_PROFILE_SCOPE("Hull::Add");
+    GEOMETRY_PROFILE_ELEMENTS(GetFaces().size() + other->GetFaces().size());
+    Materialize();
+    other->Materialize();
     HullConnector hc(*this, *other);
     if (hc.Connect())
     {
@@ -468,6 +1015,10 @@ HullPtr Hull::Add(HullPtr & other)
 
 std::vector<HullPtr> Hull::Subtract(HullPtr & other)
 {
+    GEOMETRY_PROFILE_SCOPE("Hull::Subtract");
+    GEOMETRY_PROFILE_ELEMENTS(GetFaces().size() + other->GetFaces().size());
+    Materialize();
+    other->Materialize();
     HullConnector hc(*this, *other);
     if (hc.Connect())
     {
@@ -0,0 +1,339 @@
+#include "Geometry.h"
+using namespace std;
+using namespace Geometry;
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Vectors are stored as double; they are used in place when T is double as well, with GEOMETRY_SINGLE_PRECISION
+    // they are converted once when the file is opened.
+    template<typename T>
+    using IsMappable = std::integral_constant<bool, std::is_same<typename T::value_type, double>::value>;
+
+    template<typename T, typename PACKED>
+    void Convert(const PACKED* packed, const uint64_t count, std::vector<T>& converted, std::true_type)
+    {
+        static_assert(sizeof(T) == sizeof(PACKED), "T can not be mapped");
+    }
+    template<typename T, typename PACKED>
+    void Convert(const PACKED* packed, const uint64_t count, std::vector<T>& converted, std::false_type)
+    {
+        converted.resize((size_t)count);
+        for (size_t i = 0; i < converted.size(); ++i)
+        {
+            converted[i] = T(TVector<double, T::dimension>(packed[i].m_data));
+        }
+    }
+
+    template<typename T, typename PACKED>
+    T* Locate(const PACKED* packed, const std::vector<T>& converted, const uint32_t index, std::true_type)
+    {
+        return reinterpret_cast<T*>(const_cast<PACKED*>(&packed[index]));
+    }
+    template<typename T, typename PACKED>
+    T* Locate(const PACKED* packed, const std::vector<T>& converted, const uint32_t index, std::false_type)
+    {
+        return const_cast<T*>(&converted[index]);
+    }
+
+    // The views follow edge, face and hull indices from the file without further checks; reject files in which
+    // any of them is out of range. Only vertices, normals, texture coordinates and colors may be missing (NoIndex).
+    void CheckTopology(const ShapeFormat::View& view)
+    {
+        const ShapeFormat::FileHeader& header = view.m_header;
+        for (uint64_t i = 0; i < header.m_edges.m_count; ++i)
+        {
+            const auto& edge = view.m_edges[i];
+            if (edge.m_face >= header.m_faces.m_count ||
+                edge.m_twin >= header.m_edges.m_count ||
+                edge.m_next >= header.m_edges.m_count ||
+                edge.m_prev >= header.m_edges.m_count)
+            {
+                throw std::runtime_error("Malformed shape stream");
+            }
+        }
+        for (uint64_t i = 0; i < header.m_faces.m_count; ++i)
+        {
+            const auto& face = view.m_faces[i];
+            if ((uint64_t)face.m_firstEdge + face.m_edgeCount > header.m_edges.m_count)
+            {
+                throw std::runtime_error("Malformed shape stream");
+            }
+        }
+        for (uint64_t i = 0; i < header.m_hulls.m_count; ++i)
+        {
+            const auto& hull = view.m_hulls[i];
+            if ((uint64_t)hull.m_firstFace + hull.m_faceCount > header.m_faces.m_count)
+            {
+                throw std::runtime_error("Malformed shape stream");
+            }
+        }
+    }
+}
+
+// Platform dependent file mapping
+class MappedShape::State
+{
+public:
+    State(const std::string& fileName)
+        : m_data(nullptr)
+        , m_size(0)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (INVALID_HANDLE_VALUE == m_file)
+        {
+            throw std::runtime_error("Unable to open " + fileName);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_file, &size);
+        m_size = (uint64_t)size.QuadPart;
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (nullptr != m_mapping)
+        {
+            m_data = MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+        }
+#else
+        m_file = open(fileName.c_str(), O_RDONLY);
+        if (m_file < 0)
+        {
+            throw std::runtime_error("Unable to open " + fileName);
+        }
+        struct stat info;
+        if (0 == fstat(m_file, &info) && info.st_size > 0)
+        {
+            m_size = (uint64_t)info.st_size;
+            void* data = mmap(nullptr, (size_t)m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_file, 0);
+            m_data = (MAP_FAILED == data) ? nullptr : data;
+        }
+#endif
+        if (nullptr == m_data)
+        {
+            Unmap();
+            throw std::runtime_error("Unable to map " + fileName);
+        }
+    }
+
+    ~State()
+    {
+        Unmap();
+    }
+
+    const void* GetData() const { return m_data; }
+    uint64_t GetSize() const { return m_size; }
+
+    // converted sections, only used when they can't be mapped
+    std::vector<Vertex> m_vertices;
+    std::vector<Normal> m_normals;
+    std::vector<TextureCoord> m_textureCoords;
+
+private:
+    void Unmap()
+    {
+#ifdef _WIN32
+        if (nullptr != m_data) UnmapViewOfFile(m_data);
+        if (nullptr != m_mapping) CloseHandle(m_mapping);
+        if (INVALID_HANDLE_VALUE != m_file) CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (nullptr != m_data) munmap(m_data, (size_t)m_size);
+        if (m_file >= 0) close(m_file);
+        m_file = -1;
+#endif
+        m_data = nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_file;
+#endif
+    void* m_data;
+    uint64_t m_size;
+};
+
+MappedShape::FaceView MappedShape::EdgeView::GetFace() const
+{
+    return FaceView(*m_shape, Packed().m_face);
+}
+
+void MappedShape::FaceView::ForEachEdge(std::function<void(const EdgeView& edge)> func) const
+{
+    const auto& packed = Packed();
+    for (index_type i = packed.m_firstEdge; i < packed.m_firstEdge + packed.m_edgeCount; ++i)
+    {
+        func(EdgeView(*m_shape, i));
+    }
+}
+
+void MappedShape::FaceView::ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const
+{
+    ForEachEdge([&func](const EdgeView& edge)
+    {
+        func(edge.GetStartVertex());
+    });
+}
+
+void MappedShape::HullView::ForEachFace(std::function<void(const FaceView& face)> func) const
+{
+    const auto& packed = Packed();
+    for (index_type i = packed.m_firstFace; i < packed.m_firstFace + packed.m_faceCount; ++i)
+    {
+        func(FaceView(*m_shape, i));
+    }
+}
+
+void MappedShape::HullView::ForEachEdge(std::function<void(const EdgeView& edge)> func) const
+{
+    ForEachFace([&func](const FaceView& face)
+    {
+        face.ForEachEdge(func);
+    });
+}
+
+void MappedShape::HullView::ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const
+{
+    // vertices are shared between faces; visit each of them once
+    std::vector<bool> visited(m_shape->GetVertexCount(), false);
+    ForEachEdge([&](const EdgeView& edge)
+    {
+        const index_type index = m_shape->m_view.m_edges[edge.GetIndex()].m_vertex;
+        if (index < visited.size() && !visited[index])
+        {
+            visited[index] = true;
+            func(m_shape->GetVertex(index));
+        }
+    });
+}
+
+MappedShape::MappedShape()
+    : m_state()
+{
+    memset(&m_view, 0, sizeof(m_view));
+}
+
+MappedShape::MappedShape(const std::string& fileName)
+    : MappedShape()
+{
+    Open(fileName);
+}
+
+MappedShape::~MappedShape()
+{
+    Close();
+}
+
+void MappedShape::Open(const std::string& fileName)
+{
+    Close();
+    std::unique_ptr<State> state = std::make_unique<State>(fileName);
+    ShapeFormat::View view = ShapeFormat::GetView(state->GetData(), state->GetSize());
+    CheckTopology(view);
+    m_view = view;
+    Convert(m_view.m_vertices, m_view.m_header.m_vertices.m_count, state->m_vertices, IsMappable<Vertex>());
+    Convert(m_view.m_normals, m_view.m_header.m_normals.m_count, state->m_normals, IsMappable<Normal>());
+    Convert(m_view.m_textureCoords, m_view.m_header.m_textureCoords.m_count, state->m_textureCoords, IsMappable<TextureCoord>());
+    m_state.swap(state);
+}
+
+void MappedShape::Close()
+{
+    m_state.reset();
+    memset(&m_view, 0, sizeof(m_view));
+}
+
+bool MappedShape::IsOpen() const
+{
+    return nullptr != m_state;
+}
+
+void MappedShape::ForEachHull(std::function<void(const HullView& hull)> func) const
+{
+    for (index_type i = 0; i < GetHullCount(); ++i)
+    {
+        func(HullView(*this, i));
+    }
+}
+
+void MappedShape::ForEachFace(std::function<void(const FaceView& face)> func) const
+{
+    for (index_type i = 0; i < GetFaceCount(); ++i)
+    {
+        func(FaceView(*this, i));
+    }
+}
+
+void MappedShape::ForEachEdge(std::function<void(const EdgeView& edge)> func) const
+{
+    for (index_type i = 0; i < GetEdgeCount(); ++i)
+    {
+        func(EdgeView(*this, i));
+    }
+}
+
+void MappedShape::ForEachVertex(std::function<void(const VertexRaw& vertex)> func) const
+{
+    for (index_type i = 0; i < GetVertexCount(); ++i)
+    {
+        func(GetVertex(i));
+    }
+}
+
+ShapePtr MappedShape::Materialize() const
+{
+    ShapePtr shape = Construct<Shape>();
+    if (IsOpen())
+    {
+        ShapeFormat::Unpack(m_view, *shape);
+        shape->Validate().Check("Malformed shape data");
+        shape->SetBoundingShape(GetBoundingShape());
+    }
+    return shape;
+}
+
+VertexRaw MappedShape::GetVertex(const index_type index) const
+{
+    if (index >= GetVertexCount())
+    {
+        return VertexRaw();
+    }
+    return Locate(m_view.m_vertices, m_state->m_vertices, index, IsMappable<Vertex>());
+}
+
+NormalRaw MappedShape::GetNormal(const index_type index) const
+{
+    if (index >= m_view.m_header.m_normals.m_count)
+    {
+        return NormalRaw();
+    }
+    return Locate(m_view.m_normals, m_state->m_normals, index, IsMappable<Normal>());
+}
+
+TextureCoordRaw MappedShape::GetTextureCoord(const index_type index) const
+{
+    if (index >= m_view.m_header.m_textureCoords.m_count)
+    {
+        return TextureCoordRaw();
+    }
+    return Locate(m_view.m_textureCoords, m_state->m_textureCoords, index, IsMappable<TextureCoord>());
+}
+
+ColorPtr MappedShape::GetColor(const index_type index) const
+{
+    if (index >= m_view.m_header.m_colors.m_count)
+    {
+        return nullptr;
+    }
+    return Construct<Color>((unsigned int)m_view.m_colors[index]);
+}
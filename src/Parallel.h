@@ -0,0 +1,23 @@
+#pragma once
+
+#include <future>
+#include <thread>
+
+namespace Geometry
+{
+    // Call func(begin, end) for consecutive parts of [0, count), in parallel when there are at least 2 parts of minPart
+    inline void ParallelFor(const size_t count, const std::function<void(size_t begin, size_t end)>& func, const size_t minPart = 4096)
+    {
+        const size_t parts = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count / minPart));
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 1; i < parts; ++i)
+        {
+            tasks.emplace_back(std::async(std::launch::async, func, count * i / parts, count * (i + 1) / parts));
+        }
+        func(0, count / parts);
+        for (auto& task : tasks)
+        {
+            task.get();
+        }
+    }
+}
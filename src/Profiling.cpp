@@ -0,0 +1,136 @@
+#include <chrono>
+#include <fstream>
+using namespace std;
+
+#include "Geometry.h"
+using namespace Geometry;
+
+namespace
+{
+    struct ThreadBuffer
+    {
+        std::mutex m_mutex;     // only contended while reading
+        std::vector<Profiling::Event> m_events;
+        unsigned int m_thread;
+    };
+
+    // buffers outlive their threads, so events of finished threads can still be read
+    struct Registry
+    {
+        std::mutex m_mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    };
+
+    Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer)
+        {
+            buffer = std::make_shared<ThreadBuffer>();
+            buffer->m_events.reserve(1024);
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.m_mutex);
+            buffer->m_thread = (unsigned int)registry.m_buffers.size();
+            registry.m_buffers.emplace_back(buffer);
+        }
+        return *buffer;
+    }
+
+    std::string Escape(const char* text)
+    {
+        std::string res;
+        for (; *text; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+            {
+                res += '\\';
+            }
+            res += *text;
+        }
+        return res;
+    }
+}
+
+int64_t Profiling::Now()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiling::Record(const char* name, const int64_t start, const int64_t duration, const uint64_t elements)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.m_mutex);
+    buffer.m_events.push_back({ name, start, duration, elements, buffer.m_thread });
+}
+
+std::vector<Profiling::Event> Profiling::GetEvents()
+{
+    std::vector<Event> events;
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    for (const auto& buffer : registry.m_buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+        events.insert(events.end(), buffer->m_events.begin(), buffer->m_events.end());
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.m_start < b.m_start; });
+    return events;
+}
+
+std::map<std::string, Profiling::Statistics> Profiling::GetStatistics()
+{
+    std::map<std::string, Statistics> statistics;
+    for (const Event& event : GetEvents())
+    {
+        Statistics& s = statistics.emplace(event.m_name, Statistics{ 0, 0, 0, 0 }).first->second;
+        const double ms = event.m_duration / 1e6;
+        ++s.m_calls;
+        s.m_totalMs += ms;
+        s.m_maxMs = std::max(s.m_maxMs, ms);
+        s.m_elements += event.m_elements;
+    }
+    return statistics;
+}
+
+void Profiling::Reset()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    for (const auto& buffer : registry.m_buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+        buffer->m_events.clear();
+    }
+}
+
+void Profiling::WriteChromeTrace(std::ostream& stream)
+{
+    // complete events ("ph":"X"), timestamps in microseconds
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* separator = "\n";
+    for (const Event& event : GetEvents())
+    {
+        stream << separator
+            << boost::format("{\"name\":\"%1%\",\"cat\":\"Geometry\",\"ph\":\"X\",\"ts\":%2$.3f,\"dur\":%3$.3f,\"pid\":1,\"tid\":%4%,\"args\":{\"elements\":%5%}}")
+            % Escape(event.m_name) % (event.m_start / 1e3) % (event.m_duration / 1e3) % event.m_thread % event.m_elements;
+        separator = ",\n";
+    }
+    stream << "\n]}\n";
+}
+
+void Profiling::WriteChromeTrace(const std::string& fileName)
+{
+    std::ofstream stream(fileName, std::ios::out | std::ios::trunc);
+    if (!stream)
+    {
+        throw std::runtime_error("Unable to write " + fileName);
+    }
+    WriteChromeTrace(stream);
+}
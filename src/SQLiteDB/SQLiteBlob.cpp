@@ -0,0 +1,78 @@
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include "sqlite/sqlite3.h"
+#include "SQLiteDB.h"
+
+using namespace SQLite;
+
+#include "SQLiteSupport.h"
+#include "SQLiteBlobState.h"
+
+Blob::Blob()
+    : m_state(make_shared<State>(nullptr, nullptr))
+{}
+
+Blob::Blob(std::shared_ptr<State>&& state)
+    : m_state(state)
+{}
+
+Blob::Blob(Blob&& blob)
+    : m_state(blob.m_state)
+{}
+
+Blob::Blob(const Blob& blob)
+    : m_state(blob.m_state)
+{}
+
+Blob::~Blob()
+{}
+
+Blob& Blob::operator = (const Blob& blob)
+{
+    m_state = blob.m_state;
+    return *this;
+}
+
+bool Blob::IsOpen() const
+{
+    return nullptr != m_state->m_blob;
+}
+
+int Blob::GetSize() const
+{
+    m_state->Check();
+    return sqlite3_blob_bytes(m_state->m_blob);
+}
+
+void Blob::Read(unsigned char* buffer, int length, int offset) const
+{
+    m_state->Check();
+    int ret = sqlite3_blob_read(m_state->m_blob, buffer, length, offset);
+    ThrowErrorIfNotOK(m_state->m_db, ret);
+}
+
+void Blob::Write(const unsigned char* buffer, int length, int offset)
+{
+    m_state->Check();
+    int ret = sqlite3_blob_write(m_state->m_blob, buffer, length, offset);
+    ThrowErrorIfNotOK(m_state->m_db, ret);
+}
+
+void Blob::Reopen(int64_t rowId)
+{
+    m_state->Check();
+    int ret = sqlite3_blob_reopen(m_state->m_blob, rowId);
+    ThrowErrorIfNotOK(m_state->m_db, ret);
+}
+
+void Blob::Close()
+{
+    m_state->Close();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+class Blob::State
+{
+public:
+    State(sqlite3* db, sqlite3_blob* blob)
+        : m_db(db)
+        , m_blob(blob)
+    {}
+    ~State()
+    {
+        Close();
+    }
+
+    void Check()
+    {
+        if (nullptr == m_blob)
+        {
+            ThrowError("Blob not open");
+        }
+    }
+
+    void Close()
+    {
+        if (m_blob)
+        {
+            int ret = sqlite3_blob_close(m_blob);
+            m_blob = nullptr;
+            ThrowErrorIfNotOK(m_db, ret);
+        }
+    }
+
+    sqlite3* m_db;
+    sqlite3_blob* m_blob;
+};
+
@@ -1,5 +1,8 @@
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -15,6 +18,7 @@ using namespace SQLite;
 #include "SQLiteDBState.h"
 #include "SQLiteQueryState.h"
 #include "SQLiteStatementState.h"
+#include "SQLiteBlobState.h"
 
 DB::DB()
     : m_state(std::make_shared<State>())
@@ -35,6 +39,13 @@ void DB::Close()
     m_state->Close();
 }
 
+std::string DB::GetFileName() const
+{
+    m_state->Check();
+    const char* fileName = sqlite3_db_filename(m_state->m_db, "main");
+    return fileName ? fileName : "";
+}
+
 bool DB::TableExists(const std::string& tableName)
 {
     return 0 < ExecSingleInt64("SELECT COUNT(*) FROM sqlite_master WHERE type='table' AND name='%1%'",tableName);
@@ -81,8 +92,11 @@ Query DB::ExecQuery(const std::string& sql)
 
 int64_t DB::ExecSingleInt64(const std::string& sql)
 {
-    Query q = ExecQuery(sql);
+    return GetSingleInt64(ExecQuery(sql));
+}
 
+int64_t DB::GetSingleInt64(const Query& q)
+{
     if (q.IsEOF() || q.GetFieldCount() != 1)
     {
         ThrowError("Invalid single int64 query");
@@ -93,8 +107,11 @@ int64_t DB::ExecSingleInt64(const std::string& sql)
 
 string DB::ExecSingleString(const std::string& sql)
 {
-    Query q = ExecQuery(sql);
+    return GetSingleString(ExecQuery(sql));
+}
 
+string DB::GetSingleString(const Query& q)
+{
     if (q.IsEOF() || q.GetFieldCount() != 1)
     {
         ThrowError("Invalid single string query");
@@ -109,6 +126,49 @@ Statement DB::CompileStatement(const std::string& sql)
     return std::make_shared<Statement::State>(m_state->m_db, statement, false);
 }
 
+Statement DB::PrepareStatement(const std::string& sql)
+{
+    auto state = std::make_shared<Statement::State>(m_state->m_db, m_state->Acquire(sql), false);
+    std::weak_ptr<State> db = m_state;
+    state->m_release = [db, sql](sqlite3_stmt* statement)
+    {
+        auto dbState = db.lock();
+        if (dbState)
+        {
+            dbState->Release(sql, statement);
+        }
+        else
+        {
+            sqlite3_finalize(statement);
+        }
+    };
+    return state;
+}
+
+void DB::SetStatementCacheSize(size_t size)
+{
+    m_state->m_cacheSize = size;
+    m_state->Trim(size);
+}
+
+size_t DB::GetStatementCacheCount() const
+{
+    return m_state->m_cache.size();
+}
+
+Blob DB::OpenBlob(const std::string& table, const std::string& column, int64_t rowId, bool readOnly)
+{
+    m_state->Check();
+    sqlite3_blob* blob = nullptr;
+    int ret = sqlite3_blob_open(m_state->m_db, "main", table.c_str(), column.c_str(), rowId, readOnly ? 0 : 1, &blob);
+    if (SQLITE_OK != ret)
+    {
+        sqlite3_blob_close(blob);
+        ThrowError(m_state->m_db, ret);
+    }
+    return std::make_shared<Blob::State>(m_state->m_db, blob);
+}
+
 int64_t DB::LastRowId() const
 {
     return sqlite3_last_insert_rowid(m_state->m_db);
@@ -139,3 +199,8 @@ void DB::CommitTransaction()
 {
     ExecDML("END TRANSACTION");
 }
+
+void DB::RollbackTransaction()
+{
+    ExecDML("ROLLBACK TRANSACTION");
+}
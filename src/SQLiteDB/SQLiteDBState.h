@@ -6,7 +6,12 @@ public:
     State()
         : m_db(nullptr)
         , m_busyTimeoutMs(6000)
+        , m_cacheSize(32)
     {}
+    ~State()
+    {
+        Close();
+    }
 
     void Check()
     {
@@ -30,8 +35,48 @@ public:
         return statement;
     }
 
+    // take a statement from the cache, or compile a new one
+    sqlite3_stmt* Acquire(const std::string& sql)
+    {
+        auto iter = m_cacheIndex.find(sql);
+        if (iter == m_cacheIndex.end())
+        {
+            return Compile(sql);
+        }
+        sqlite3_stmt* statement = iter->second->second;
+        m_cache.erase(iter->second);
+        m_cacheIndex.erase(iter);
+        return statement;
+    }
+
+    // hand a statement back to the cache, dropping the least recently used one if it's full
+    void Release(const std::string& sql, sqlite3_stmt* statement)
+    {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        if (m_db != sqlite3_db_handle(statement) || 0 == m_cacheSize || m_cacheIndex.end() != m_cacheIndex.find(sql))
+        {
+            sqlite3_finalize(statement);
+            return;
+        }
+        m_cache.emplace_front(sql, statement);
+        m_cacheIndex.emplace(sql, m_cache.begin());
+        Trim(m_cacheSize);
+    }
+
+    void Trim(size_t size)
+    {
+        while (m_cache.size() > size)
+        {
+            sqlite3_finalize(m_cache.back().second);
+            m_cacheIndex.erase(m_cache.back().first);
+            m_cache.pop_back();
+        }
+    }
+
     void Close()
     {
+        Trim(0);
         if (m_db)
         {
             sqlite3_close(m_db);
@@ -41,5 +86,8 @@ public:
 
     sqlite3* m_db;
     int m_busyTimeoutMs;
+    size_t m_cacheSize;
+    std::list<std::pair<std::string, sqlite3_stmt*>> m_cache; // most recently used first
+    std::unordered_map<std::string, std::list<std::pair<std::string, sqlite3_stmt*>>::iterator> m_cacheIndex;
 };
 
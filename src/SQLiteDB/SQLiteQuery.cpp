@@ -1,5 +1,8 @@
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 
@@ -214,6 +217,23 @@ std::vector<unsigned char> Query::GetBlobField(const std::string& field) const
     return GetBlobField(index);
 }
 
+void Query::GetBlobField(int field, const unsigned char*& data, int& length) const
+{
+    data = nullptr;
+    length = 0;
+    if (FieldDataType(field) != DataType::Null)
+    {
+        data = (const unsigned char*)sqlite3_column_blob(m_state->m_statement, field);
+        length = sqlite3_column_bytes(m_state->m_statement, field);
+    }
+}
+
+void Query::GetBlobField(const std::string& field, const unsigned char*& data, int& length) const
+{
+    int index = FieldIndex(field);
+    GetBlobField(index, data, length);
+}
+
 bool Query::FieldIsNull(int field) const
 {
     return (FieldDataType(field) != DataType::Null);
@@ -3,12 +3,13 @@
 class Query::State
 {
 public:
-    State(sqlite3* db, sqlite3_stmt* statement, bool eof,bool owner = true,int columnCount = -1)
+    State(sqlite3* db, sqlite3_stmt* statement, bool eof,bool owner = true,int columnCount = -1,std::shared_ptr<Statement::State> statementState = nullptr)
         : m_db(db)
         , m_statement(statement)
         , m_eof(eof)
         , m_owner(owner)
         , m_columnCount(columnCount)
+        , m_statementState(statementState)
     {
         if (-1 == m_columnCount)
         {
@@ -43,6 +44,7 @@ public:
             ThrowErrorIfNotOK(m_db, ret);
         }
         m_statement = nullptr;
+        m_statementState.reset();
     }
 
     sqlite3_stmt* m_statement;
@@ -51,6 +53,7 @@ public:
     bool m_owner;
     int m_columnCount;
     std::vector<std::string> m_fieldNames;
+    std::shared_ptr<Statement::State> m_statementState; // keeps a non-owned statement alive
 };
 
 
@@ -1,5 +1,8 @@
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -73,12 +76,12 @@ Query Statement::ExecQuery()
     if (ret == SQLITE_DONE)
     {
         // no rows
-        return std::make_shared<Query::State>(m_state->m_db, m_state->m_statement, true, false);
+        return std::make_shared<Query::State>(m_state->m_db, m_state->m_statement, true, false, -1, m_state);
     }
     else if (ret == SQLITE_ROW)
     {
         // at least 1 row
-        return std::make_shared<Query::State>(m_state->m_db, m_state->m_statement, false, false);
+        return std::make_shared<Query::State>(m_state->m_db, m_state->m_statement, false, false, -1, m_state);
     }
     else
     {
@@ -128,6 +131,18 @@ void Statement::Bind(int param, const unsigned char* value, int length)
     ThrowErrorIfNotOK("Error binding blob param", ret);
 }
 
+void Statement::Bind(int param, const std::vector<unsigned char>& value)
+{
+    Bind(param, value.data(), static_cast<int>(value.size()));
+}
+
+void Statement::BindZeroBlob(int param, int length)
+{
+    m_state->Check();
+    int ret = sqlite3_bind_zeroblob(m_state->m_statement, param, length);
+    ThrowErrorIfNotOK("Error binding zeroblob param", ret);
+}
+
 void Statement::BindNull(int param)
 {
     m_state->Check();
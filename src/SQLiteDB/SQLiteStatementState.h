@@ -35,9 +35,17 @@ public:
     {
         if (m_statement)
         {
-            int ret = sqlite3_finalize(m_statement);
+            sqlite3_stmt* statement = m_statement;
             m_statement = nullptr;
-            ThrowErrorIfNotOK(m_db, ret);
+            if (m_release)
+            {
+                m_release(statement);
+            }
+            else
+            {
+                int ret = sqlite3_finalize(statement);
+                ThrowErrorIfNotOK(m_db, ret);
+            }
         }
     }
 
@@ -55,6 +63,7 @@ public:
     sqlite3* m_db;
     bool m_eof;
     int m_columnCount;
+    std::function<void(sqlite3_stmt*)> m_release; // set for statements from the statement cache
 };
 
 
@@ -1,24 +1,37 @@
 #include <future>
 #include <chrono>
+#include <condition_variable>
+#include <thread>
 using namespace std;
 
 #include "Geometry.h"
+#include "ShapeStorage.h"
+#include "Parallel.h"
 using namespace Geometry;
+using namespace Geometry::ShapeStorage;
 
 namespace
 {
-    size_t SerializationVersion = 1;
+    // 1: one row per element, 2: packed arrays per hull in blob columns
+    const int64_t RowsSerializationVersion = 1;
+    const int64_t SerializationVersion = 2;
 }
 
 Shape::Shape()
     : m_hulls()
     , m_boundingShape()
+    , m_derivedType(BoundingShape3d::Type::Unknown)
+    , m_derivedValid(false)
+    , m_derivedSignature(0)
 {    
 }
 
 Shape::Shape(const this_type &other)
     : m_hulls()
     , m_boundingShape(other.m_boundingShape)
+    , m_derivedType(other.m_derivedType)
+    , m_derivedValid(false)
+    , m_derivedSignature(0)
 {
     for (const auto& hull : other.m_hulls)
     {
@@ -29,6 +42,9 @@ Shape::Shape(const this_type &other)
 Shape::Shape(this_type &&other)
     : m_hulls()
     , m_boundingShape()
+    , m_derivedType(other.m_derivedType)
+    , m_derivedValid(false)
+    , m_derivedSignature(0)
 {
     other.m_hulls.swap(m_hulls);
     std::swap(m_boundingShape, other.m_boundingShape);
@@ -39,6 +55,18 @@ Shape::~Shape()
     Clear();
 }
 
+ShapePtr Shape::Instance() const
+{
+    ShapePtr shape = Construct<Shape>();
+    shape->m_boundingShape = m_boundingShape;
+    shape->m_derivedType = m_derivedType;
+    for (const auto& hull : m_hulls)
+    {
+        hull->Instance(*shape);
+    }
+    return shape;
+}
+
 void Shape::ForEachHull(std::function<void(const HullRaw& hull)> func) const
 {
     for (const HullPtr& hull : GetHulls())
@@ -127,6 +155,7 @@ void Shape::Triangulate()
 
 void Shape::Scale(const double factor)
 {
+    m_boundingShape.Scale(factor);
     ParallelForEachHull([factor](const HullRaw& hull)
     {
         hull->Scale(factor);
@@ -135,50 +164,98 @@ void Shape::Scale(const double factor)
 
 void Shape::Translate(const Vector3d& translation)
 {
+    m_boundingShape.Translate(translation);
     ParallelForEachHull([translation](const HullRaw& hull)
     {
         hull->Translate(translation);
     });
 }
 
-void Shape::Clear()
+void Shape::Rotate(const Quat& rotation)
 {
-    m_hulls.clear();
-    m_boundingShape.Clear();
+    m_boundingShape.Rotate(rotation);
+    ParallelForEachHull([rotation](const HullRaw& hull)
+    {
+        hull->Rotate(rotation);
+    });
 }
 
-// Helper for Store
-template<typename T>
-static void StoreVectorMap(SQLite::DB& db,const std::unordered_map<T,size_t>& m,const std::string& table)
+void Shape::RefineBoundingShapes()
 {
-    SQLite::Statement stat;
-    db.ExecDML("DROP TABLE IF EXISTS %1%", table);
-    switch (T::element_type::dimension)
+    GEOMETRY_PROFILE_SCOPE("Shape::RefineBoundingShapes");
+    ParallelForEachHull([](const HullRaw& hull)
     {
-    case 2:
-        db.ExecDML("CREATE TABLE %1%(Id INTEGER PRIMARY KEY,x FLOAT,y FLOAT) WITHOUT ROWID", table);
-        stat = db.CompileStatement("INSERT INTO %1%(Id,x,y) VALUES(?1,?2,?3)", table);
-        break;
-    default:
-        assert(false); // Unsupported dimension
-    case 3:
-        db.ExecDML("CREATE TABLE %1%(Id INTEGER PRIMARY KEY,x FLOAT,y FLOAT,z FLOAT) WITHOUT ROWID", table);
-        stat = db.CompileStatement("INSERT INTO %1%(Id,x,y,z) VALUES(?1,?2,?3,?4)", table);
-        break;
+        const BoundingShape3d& boundingShape = hull->GetBoundingShape();
+        const BoundingShape3d::Type type = boundingShape.GetType();
+        if (!boundingShape.IsOptimal() && (type == BoundingShape3d::Type::Ball || type == BoundingShape3d::Type::Box))
+        {
+            hull->CalculateBoundingShape(type);
+        }
+    });
+}
+
+void Shape::DeriveBoundingShape(const BoundingShape3d::Type type)
+{
+    if (type != BoundingShape3d::Type::Unknown && type != BoundingShape3d::Type::Ball && type != BoundingShape3d::Type::Box)
+    {
+        throw std::runtime_error("A shape bounding shape can only be derived as a ball or a box");
     }
-    for (auto& item : m)
+    m_derivedType = type;
+    m_derivedValid = false;
+}
+
+void Shape::UpdateDerivedBoundingShape() const
+{
+    // the generation of a hull changes with everything which can change its bounding shape
+    uint64_t signature = 0;
+    for (const HullPtr& hull : m_hulls)
+    {
+        uint64_t x = (uint64_t)hull.get() + 0x9e3779b97f4a7c15ull * (hull->GetGeneration() + 1);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        signature += x ^ (x >> 31);
+    }
+    if (m_derivedValid && signature == m_derivedSignature)
     {
-        if (item.first) // skip null values
+        return;
+    }
+    GEOMETRY_PROFILE_SCOPE("Shape::UpdateDerivedBoundingShape");
+    GEOMETRY_PROFILE_ELEMENTS(m_hulls.size());
+    BoundingShape3d boundingShape;
+    for (const HullPtr& hull : m_hulls)
+    {
+        BoundingShape3d hullBoundingShape = hull->GetBoundingShape();
+        if (!hullBoundingShape.IsInitialized())
         {
-            stat.Reset();
-            stat.Bind(1, (int64_t)item.second);
-            for (int i = 0; i < T::element_type::dimension; ++i)
-            {
-                stat.Bind(2+i, (*item.first)[i]);
-            }
-            stat.ExecDML();
+            boundingShape.Clear();
+            break;
         }
+        hullBoundingShape.Convert(m_derivedType);
+        boundingShape.Enclose(hullBoundingShape);
     }
+    m_boundingShape = boundingShape;
+    m_derivedSignature = signature;
+    m_derivedValid = true;
+}
+
+void Shape::Clear()
+{
+    m_derivedValid = false;
+    m_hulls.clear();
+    m_boundingShape.Clear();
+    m_storeToken.clear();
+}
+
+std::vector<HullRaw> Shape::GetMaterializedHulls(Shape& materialized) const
+{
+    // instanced hulls are stored as a transformed copy of their geometry
+    std::vector<HullRaw> hulls;
+    hulls.reserve(m_hulls.size());
+    ForEachHull([&](const HullRaw& hull)
+    {
+        hulls.emplace_back(hull->IsInstance() ? HullRaw(hull->Copy(materialized)) : hull);
+    });
+    return hulls;
 }
 
 // Helper for Retrieve
@@ -211,105 +288,540 @@ static void ReadVectorMap(SQLite::DB& db, std::unordered_map<size_t, std::shared
     m.emplace(0, nullptr);
 }
 
-namespace 
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double ElapsedMs(const Clock::time_point& start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Fulfil the promise with the result of work, or with the exception it throws (which is passed on)
+    template<typename T>
+    void Produce(std::promise<T>& promise, std::function<T()> work)
+    {
+        try
+        {
+            promise.set_value(work());
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    template<typename T>
+    std::unordered_map<size_t, std::shared_ptr<T>> ReadVectorTable(SQLite::DB& db, const std::string& table)
+    {
+        std::unordered_map<size_t, std::shared_ptr<T>> m;
+        ReadVectorMap(db, m, table);
+        return m;
+    }
+
+    template<typename T>
+    std::vector<T> ReadRows(SQLite::DB& db, const std::string& sql, std::function<T(const SQLite::Query& query)> row)
+    {
+        std::vector<T> rows;
+        SQLite::Query query = db.ExecQuery(sql);
+        for (; !query.IsEOF(); query.NextRow())
+        {
+            rows.emplace_back(row(query));
+        }
+        return rows;
+    }
+
+    template<typename K, typename V>
+    const V& FindOrNull(const std::unordered_map<K, V>& m, const K& key)
+    {
+        static const V null = nullptr;
+        auto iter = m.find(key);
+        return (iter == m.end()) ? null : iter->second;
+    }
+
+    struct HullRow
+    {
+        int64_t m_id;
+        int m_orientation;
+        int64_t m_color;
+        int64_t m_boundingShape;
+    };
+
+    struct FaceRow
+    {
+        int64_t m_id;
+        int64_t m_hull;
+        int64_t m_normal;
+        int64_t m_color;
+    };
+
+    struct EdgeRow
+    {
+        int64_t m_id;
+        int64_t m_vertex;
+        int64_t m_normal;
+        int64_t m_face;
+        int64_t m_twin;
+        int64_t m_next;
+        int64_t m_prev;
+        int64_t m_color;
+        int64_t m_textureCoord;
+    };
+}
+
+namespace
 {
-    struct Orientation
+    // Insert rows into a table, rowsPerInsert rows per INSERT statement. Values are added in column order.
+    class RowInserter
     {
-        static int64_t Convert(Hull::Orientation orientation)
+    public:
+        RowInserter(SQLite::DB& db, const std::string& table, const std::vector<std::string>& columns, const bool bulk)
+            : m_db(db)
+            , m_table(table)
+            , m_columns(columns)
+            , m_rowsPerInsert(bulk ? MaxParams / (int)columns.size() : 1)
         {
-            switch (orientation)
+            m_values.reserve(m_rowsPerInsert * columns.size());
+            m_statement = Compile(m_rowsPerInsert);
+        }
+        void Add(const int64_t value) { m_values.push_back({ Value::Type::Int, value, 0.0 }); Check(); }
+        void Add(const double value) { m_values.push_back({ Value::Type::Float, 0, value }); Check(); }
+        void AddNull() { m_values.push_back({ Value::Type::Null, 0, 0.0 }); Check(); }
+
+        // insert the remaining rows
+        void Flush()
+        {
+            if (!m_values.empty())
             {
-            case Hull::Orientation::Inward: return 0;
-            case Hull::Orientation::Outward: return 1;
-            default:
-                assert(false); // wickedly wrong orientation value!
-                return -1;
+                SQLite::Statement statement = Compile((int)(m_values.size() / m_columns.size()));
+                Insert(statement);
             }
         }
-        static Hull::Orientation Convert(int64_t orientation)
+
+    private:
+        // stay below the smallest SQLITE_MAX_VARIABLE_NUMBER (999)
+        static const int MaxParams = 999;
+
+        struct Value
+        {
+            enum class Type { Int, Float, Null } m_type;
+            int64_t m_int;
+            double m_float;
+        };
+
+        SQLite::Statement Compile(const int rows)
         {
-            switch (orientation)
+            std::string sql = "INSERT INTO " + m_table + "(";
+            std::string row = "(";
+            for (size_t i = 0; i < m_columns.size(); ++i)
             {
-            case 0: return Hull::Orientation::Inward;
-            default:
-                assert(false); // wickedly wrong orientation value!
-            case 1: return Hull::Orientation::Outward;
+                sql += (i ? "," : "") + m_columns[i];
+                row += (i ? ",?" : "?");
+            }
+            sql += ") VALUES";
+            row += ")";
+            for (int i = 0; i < rows; ++i)
+            {
+                sql += (i ? "," : "") + row;
             }
+            return m_db.CompileStatement(sql);
         }
+
+        void Check()
+        {
+            if (m_values.size() == m_rowsPerInsert * m_columns.size())
+            {
+                Insert(m_statement);
+            }
+        }
+
+        void Insert(SQLite::Statement& statement)
+        {
+            statement.Reset();
+            int param = 1;
+            for (const Value& value : m_values)
+            {
+                switch (value.m_type)
+                {
+                case Value::Type::Int: statement.Bind(param++, value.m_int); break;
+                case Value::Type::Float: statement.Bind(param++, value.m_float); break;
+                default: statement.BindNull(param++); break;
+                }
+            }
+            statement.ExecDML();
+            m_values.clear();
+        }
+
+        SQLite::DB& m_db;
+        std::string m_table;
+        std::vector<std::string> m_columns;
+        size_t m_rowsPerInsert;
+        SQLite::Statement m_statement;
+        std::vector<Value> m_values;
     };
-    struct BoundingShapeType
+
+    // Create a table for the rows layout. The row by row layout clusters the table on Id (WITHOUT ROWID),
+    // in bulk Id is the rowid itself: rows are inserted in Id order, so there is no index to maintain at all.
+    void CreateRowsTable(SQLite::DB& db, const std::string& table, const std::string& columns, const bool bulk)
+    {
+        db.ExecDML("CREATE TABLE %1%(Id INTEGER PRIMARY KEY,%2%)%3%", table, columns, bulk ? "" : " WITHOUT ROWID");
+    }
+
+    // The keys of m (ids 1..n) ordered by id; id 0 is the null value
+    template<typename T>
+    std::vector<T> OrderById(const std::unordered_map<T, size_t>& m)
+    {
+        std::vector<T> res(m.size());
+        for (auto& item : m)
+        {
+            res[item.second] = item.first;
+        }
+        return res;
+    }
+
+    template<typename T>
+    void StoreVectorMap(SQLite::DB& db, const std::unordered_map<T, size_t>& m, const std::string& table, const bool bulk)
     {
-        static int64_t Convert(BoundingShape3d::Type type)
+        std::vector<std::string> columns = { "Id", "x", "y", "z" };
+        columns.resize(1 + T::element_type::dimension);
+        CreateRowsTable(db, table, T::element_type::dimension == 2 ? "x FLOAT,y FLOAT" : "x FLOAT,y FLOAT,z FLOAT", bulk);
+        RowInserter inserter(db, table, columns, bulk);
+        const std::vector<T> items = OrderById(m);
+        for (size_t id = 1; id < items.size(); ++id)
         {
-            switch (type)
+            inserter.Add((int64_t)id);
+            for (int i = 0; i < T::element_type::dimension; ++i)
             {
-            default:
-                assert(false); // wickedly wrong type value!
-            case BoundingShape3d::Type::Unknown: return 0;
-            case BoundingShape3d::Type::Ball: return 1;
-            case BoundingShape3d::Type::Box: return 2;
+                inserter.Add((double)(*items[id])[i]);
             }
         }
-        static BoundingShape3d::Type Convert(int64_t type)
+        inserter.Flush();
+    }
+
+    // version 1 layout: one row per vertex, normal, texture coordinate, edge and face
+    void StoreRows(SQLite::DB& db, const std::vector<HullRaw>& storedHulls, const BoundingShapeStorer& StoreBoundingShape, const bool bulk)
+    {
+        std::unordered_map<HullRaw, size_t> hulls;
+        std::unordered_map<EdgeRaw, size_t> edges;
+        std::unordered_map<VertexRaw, size_t> vertices;
+        std::unordered_map<NormalRaw, size_t> normals;
+        std::unordered_map<TextureCoordRaw, size_t> textureCoords;
+        std::unordered_map<FaceRaw, size_t> faces;
+
+        // start with 'null' values
+        hulls.emplace(nullptr, 0);
+        normals.emplace(nullptr, 0);
+        faces.emplace(nullptr, 0);
+        edges.emplace(nullptr, 0);
+        vertices.emplace(nullptr, 0);
+        textureCoords.emplace(nullptr, 0);
+
+        for (const HullRaw& hull : storedHulls)
         {
-            switch (type)
+            hulls.emplace(hull, hulls.size());
+            hull->ForEachFace([&](const FaceRaw& face)
             {
-            default:
-                assert(false); // wickedly wrong orientation value!
-            case 0: return BoundingShape3d::Type::Unknown;
-            case 1: return BoundingShape3d::Type::Ball;
-            case 2: return BoundingShape3d::Type::Box;
+                normals.emplace(face->GetNormal(), normals.size());
+                faces.emplace(face, faces.size());
+                face->ForEachEdge([&](const EdgeRaw& edge)
+                {
+                    edges.emplace(edge, edges.size());
+                    vertices.emplace(edge->GetStartVertex(), vertices.size());
+                    normals.emplace(edge->GetStartNormal(), normals.size());
+                    textureCoords.emplace(edge->GetStartTextureCoord(), textureCoords.size());
+                });
+            });
+        }
+
+        // Normals
+        StoreVectorMap(db, normals, "Normals", bulk);
+
+        // Vertices
+        StoreVectorMap(db, vertices, "Vertices", bulk);
+
+        // TextureCoords
+        StoreVectorMap(db, textureCoords, "TextureCoords", bulk);
+
+        auto ColorId = [](const ColorPtr& color) { return (int64_t)(color ? color->GetInt() : -1); };
+
+        // Edges
+        CreateRowsTable(db, "Edges", "Vertex INTEGER,Normal INTEGER,Face INTEGER,Twin INTEGER,Next INTEGER,Prev INTEGER,Color INTEGER,TextureCoord INTEGER", bulk);
+        {
+            RowInserter inserter(db, "Edges", { "Id","Vertex","Normal","Face","Twin","Next","Prev","Color","TextureCoord" }, bulk);
+            const std::vector<EdgeRaw> orderedEdges = OrderById(edges);
+            for (size_t id = 1; id < orderedEdges.size(); ++id)
+            {
+                const EdgeRaw& edge = orderedEdges[id];
+                inserter.Add((int64_t)id);
+                inserter.Add((int64_t)vertices[edge->GetStartVertex()]);
+                inserter.Add((int64_t)normals[edge->GetStartNormal()]);
+                inserter.Add((int64_t)faces[edge->GetFace()]);
+                inserter.Add((int64_t)edges[edge->GetTwin()]);
+                inserter.Add((int64_t)edges[edge->GetNext()]);
+                inserter.Add((int64_t)edges[edge->GetPrev()]); // not needed?
+                inserter.Add(ColorId(edge->GetStartColor()));
+                inserter.Add((int64_t)textureCoords[edge->GetStartTextureCoord()]);
             }
+            inserter.Flush();
         }
+
+        // Faces
+        CreateRowsTable(db, "Faces", "Hull INTEGER,Normal INTEGER,Color INTEGER", bulk);
+        {
+            RowInserter inserter(db, "Faces", { "Id","Hull","Normal","Color" }, bulk);
+            const std::vector<FaceRaw> orderedFaces = OrderById(faces);
+            for (size_t id = 1; id < orderedFaces.size(); ++id)
+            {
+                const FaceRaw& face = orderedFaces[id];
+                inserter.Add((int64_t)id);
+                inserter.Add((int64_t)hulls[face->GetHull()]);
+                inserter.Add((int64_t)normals[face->GetNormal()]);
+                inserter.Add(ColorId(face->GetColor()));
+            }
+            inserter.Flush();
+        }
+
+        // Hulls
+        CreateRowsTable(db, "Hulls", "Shape INTEGER,Orientation INTEGER,Color INTEGER,BoundingShape INTEGER", bulk);
+        {
+            RowInserter inserter(db, "Hulls", { "Id","Shape","Orientation","Color","BoundingShape" }, bulk);
+            const std::vector<HullRaw> orderedHulls = OrderById(hulls);
+            for (size_t id = 1; id < orderedHulls.size(); ++id)
+            {
+                const HullRaw& hull = orderedHulls[id];
+                inserter.Add((int64_t)id);
+                inserter.Add((int64_t)0);
+                inserter.Add(Orientation::Convert(hull->GetOrientation()));
+                inserter.Add(ColorId(hull->GetColor()));
+                inserter.Add(StoreBoundingShape(hull->GetBoundingShape()));
+            }
+            inserter.Flush();
+        }
+    }
+
+    // Pragmas for a bulk store: no syncing and an in-memory rollback journal, restored when done.
+    // A db in WAL mode keeps its journal mode; switching out of WAL needs exclusive access.
+    class BulkPragmas
+    {
+    public:
+        BulkPragmas(SQLite::DB& db)
+            : m_db(db)
+            , m_journalMode(db.ExecSingleString("PRAGMA journal_mode"))
+            , m_synchronous(db.ExecSingleInt64("PRAGMA synchronous"))
+        {
+            if (0 == db.ExecSingleInt64("PRAGMA page_count"))
+            {
+                // the page size can only be chosen for a new db
+                db.ExecDML("PRAGMA page_size=16384");
+            }
+            if (m_journalMode == "delete" || m_journalMode == "truncate" || m_journalMode == "persist")
+            {
+                db.ExecDML("PRAGMA journal_mode=MEMORY");
+            }
+            db.ExecDML("PRAGMA synchronous=OFF");
+        }
+        ~BulkPragmas()
+        {
+            try
+            {
+                m_db.ExecDML("PRAGMA journal_mode=%1%", m_journalMode);
+                m_db.ExecDML("PRAGMA synchronous=%1%", m_synchronous);
+            }
+            catch (const std::exception&)
+            {
+                // a failed Store rolled back already; nothing sensible to do when restoring fails anyway
+            }
+        }
+    private:
+        SQLite::DB& m_db;
+        std::string m_journalMode;
+        int64_t m_synchronous;
     };
-}
 
-void Shape::Store(SQLite::DB& db) const
-{
-    ForEachFace([](const FaceRaw& face) {face->CheckPointering(); });
+    template<typename T>
+    void BindBlob(SQLite::Statement& s, const int param, const std::vector<T>& items)
+    {
+        s.Bind(param, reinterpret_cast<const unsigned char*>(items.data()), (int)(items.size() * sizeof(T)));
+    }
 
-    std::unordered_map<HullRaw, size_t> hulls;
-    std::unordered_map<EdgeRaw, size_t> edges;
-    std::unordered_map<VertexRaw, size_t> vertices;
-    std::unordered_map<NormalRaw, size_t> normals;
-    std::unordered_map<TextureCoordRaw, size_t> textureCoords;
-    std::unordered_map<FaceRaw, size_t> faces;
+    template<typename T>
+    void GetBlob(const SQLite::Query& query, const int field, std::vector<T>& items)
+    {
+        const unsigned char* data;
+        int length;
+        query.GetBlobField(field, data, length);
+        if (length % sizeof(T) != 0)
+        {
+            throw std::runtime_error("Malformed hull blob");
+        }
+        items.resize(length / sizeof(T));
+        if (length > 0)
+        {
+            memcpy(items.data(), data, length);
+        }
+    }
 
-    // start with 'null' values
-    hulls.emplace(nullptr, 0);
-    normals.emplace(nullptr, 0);
-    faces.emplace(nullptr, 0);
-    edges.emplace(nullptr, 0);
-    vertices.emplace(nullptr, 0);
-    textureCoords.emplace(nullptr, 0);
+    // hull i is stored with Id i+1
+    void StoreBlobs(SQLite::DB& db, const std::vector<HullRaw>& storedHulls, const BoundingShapeStorer& StoreBoundingShape, std::vector<int64_t>& ids)
+    {
+        CreateHullsTable(db);
+        SQLite::Statement s = db.CompileStatement(HullsInsert);
+        for (size_t i = 0; i < storedHulls.size(); ++i)
+        {
+            ids[i] = (int64_t)(i + 1);
+            InsertHull(s, ids[i], 0, storedHulls[i], storedHulls[i]->GetBoundingShape(), StoreBoundingShape);
+        }
+    }
 
-    ForEachHull([&](const HullRaw& hull)
+    // Rewrite only the hulls which are new or modified since they were stored, and remove the rows of hulls
+    // which are gone; unmodified hulls keep their row. hulls are the shape's own hulls, storedHulls what to write for them.
+    void StoreBlobsDelta(SQLite::DB& db, const std::vector<HullRaw>& hulls, const std::vector<HullRaw>& storedHulls, const BoundingShapeStorer& StoreBoundingShape, std::vector<int64_t>& ids)
     {
-        hulls.emplace(hull, hulls.size());
-        hull->ForEachFace([&](const FaceRaw& face)
+        // rows in the db, with their bounding shape
+        std::unordered_map<int64_t, int64_t> rows;
+        int64_t nextId = 1;
+        SQLite::Query query = db.ExecQuery("SELECT Id,BoundingShape FROM Hulls");
+        for (; !query.IsEOF(); query.NextRow())
         {
-            normals.emplace(face->GetNormal(), normals.size());
-            faces.emplace(face, faces.size());
-            face->ForEachEdge([&](const EdgeRaw& edge)
+            const int64_t id = query.GetInt64Field(0);
+            rows.emplace(id, query.GetInt64Field(1));
+            nextId = std::max(nextId, id + 1);
+        }
+        query.Finalize();
+
+        auto RemoveRow = [&db](const int64_t id, const int64_t boundingShapeId)
+        {
+            db.ExecDMLParams("DELETE FROM Hulls WHERE Id=?1", id);
+            db.ExecDMLParams("DELETE FROM BoundingShapes WHERE Id=?1 AND Id<>0", boundingShapeId);
+        };
+
+        SQLite::Statement s = db.CompileStatement(HullsInsert);
+        for (size_t i = 0; i < hulls.size(); ++i)
+        {
+            int64_t id = hulls[i]->GetStoreId();
+            auto row = rows.find(id);
+            if (0 != id && rows.end() != row)
             {
-                edges.emplace(edge, edges.size());
-                vertices.emplace(edge->GetStartVertex(), vertices.size());
-                normals.emplace(edge->GetStartNormal(), normals.size());
-                textureCoords.emplace(edge->GetStartTextureCoord(), textureCoords.size());
-            });
-        });
-    });
+                const int64_t boundingShapeId = row->second;
+                rows.erase(row);
+                if (!hulls[i]->IsModifiedSinceStore())
+                {
+                    ids[i] = id;
+                    continue;
+                }
+                RemoveRow(id, boundingShapeId);
+            }
+            else
+            {
+                id = nextId++;
+            }
+            ids[i] = id;
+            InsertHull(s, id, 0, storedHulls[i], storedHulls[i]->GetBoundingShape(), StoreBoundingShape);
+        }
 
-    // All work within one transaction
-    db.BeginTransaction();
+        // hulls removed from the shape
+        for (const auto& row : rows)
+        {
+            RemoveRow(row.first, row.second);
+        }
+    }
+
+    // a new random token identifying a stored db state
+    std::string NewStoreToken()
+    {
+        static std::mutex mutex;
+        static std::mt19937_64 generator(std::random_device{}());
+        std::lock_guard<std::mutex> lock(mutex);
+        return boost::str(boost::format("%016x%016x") % generator() % generator());
+    }
+}
+
+namespace
+{
+    bool HasOrientationColumns(SQLite::DB& db)
+    {
+        return 0 != db.ExecSingleInt64("SELECT COUNT(*) FROM pragma_table_info('BoundingShapes') WHERE name='qw'");
+    }
+
+    // rotation which takes the coordinate axes to the (orthonormal) axes
+    Quat AxesToRotation(BoundingShape3d::axes_type axes)
+    {
+        // a rotation keeps the handedness
+        if (ScalarTripleProduct(axes[0], axes[1], axes[2]) < 0)
+        {
+            axes[2] *= -1.0;
+        }
+        // r[i][j] = axes[j][i], Shepperd's method: divide by the largest of 4w^2, 4x^2, 4y^2, 4z^2
+        auto r = [&axes](const int i, const int j) { return axes[j][i]; };
+        const double trace = r(0, 0) + r(1, 1) + r(2, 2);
+        if (trace > 0)
+        {
+            const double s = 2 * sqrt(trace + 1);
+            return Quat(s / 4, (r(2, 1) - r(1, 2)) / s, (r(0, 2) - r(2, 0)) / s, (r(1, 0) - r(0, 1)) / s);
+        }
+        else if (r(0, 0) >= r(1, 1) && r(0, 0) >= r(2, 2))
+        {
+            const double s = 2 * sqrt(1 + r(0, 0) - r(1, 1) - r(2, 2));
+            return Quat((r(2, 1) - r(1, 2)) / s, s / 4, (r(0, 1) + r(1, 0)) / s, (r(0, 2) + r(2, 0)) / s);
+        }
+        else if (r(1, 1) >= r(2, 2))
+        {
+            const double s = 2 * sqrt(1 + r(1, 1) - r(0, 0) - r(2, 2));
+            return Quat((r(0, 2) - r(2, 0)) / s, (r(0, 1) + r(1, 0)) / s, s / 4, (r(1, 2) + r(2, 1)) / s);
+        }
+        else
+        {
+            const double s = 2 * sqrt(1 + r(2, 2) - r(0, 0) - r(1, 1));
+            return Quat((r(1, 0) - r(0, 1)) / s, (r(0, 2) + r(2, 0)) / s, (r(1, 2) + r(2, 1)) / s, s / 4);
+        }
+    }
+
+    BoundingShape3d::axes_type RotationToAxes(const Quat& rotation)
+    {
+        double r[3][3];
+        rotation.Normalized().GetRotationMatrix3rows(r[0], r[1], r[2]);
+        BoundingShape3d::axes_type axes;
+        for (int k = 0; k < 3; ++k)
+        {
+            axes[k] = Vector3d(r[0][k], r[1][k], r[2][k]);
+        }
+        return axes;
+    }
+}
 
-    // prepare for storing BoundingShapes
-    db.ExecDML("DROP TABLE IF EXISTS BoundingShapes");
-    db.ExecDML("CREATE TABLE BoundingShapes(Id INTEGER PRIMARY KEY,Type INTEGER,x0 FLOAT,y0 FLOAT,z0 FLOAT,x1 FLOAT,y1 FLOAT,z1 FLOAT,Radius FLOAT,Optimal INTEGER) WITHOUT ROWID");
+void ShapeStorage::CreateBoundingShapesTable(SQLite::DB& db)
+{
+    db.ExecDML("CREATE TABLE BoundingShapes(Id INTEGER PRIMARY KEY,Type INTEGER,x0 FLOAT,y0 FLOAT,z0 FLOAT,x1 FLOAT,y1 FLOAT,z1 FLOAT,Radius FLOAT,Optimal INTEGER,qw FLOAT,qx FLOAT,qy FLOAT,qz FLOAT) WITHOUT ROWID");
     db.ExecDML("INSERT INTO BoundingShapes(Id,Type,x0,y0,z0,x1,y1,z1,Radius,Optimal) VALUES(0,%1%,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL)",BoundingShapeType::Convert(BoundingShape3d::Type::Unknown));
-    SQLite::Statement boundingShapeStatement = db.CompileStatement("INSERT INTO BoundingShapes(Id,Type,x0,y0,z0,x1,y1,z1,Radius,Optimal) VALUES(?1,?2,?3,?4,?5,?6,?7,?8,?9,?10)");
-    int boundingShapeCount = 1;
-    auto StoreBoundingShape = [&boundingShapeStatement,&boundingShapeCount](const BoundingShape3d& bs)
+}
+
+std::string ShapeStorage::BoundingShapeColumns(SQLite::DB& db, const std::string& prefix)
+{
+    std::string columns;
+    for (const char* column : { "Type","x0","y0","z0","x1","y1","z1","Radius","Optimal" })
+    {
+        columns += (columns.empty() ? "" : ",") + prefix + column;
+    }
+    if (HasOrientationColumns(db))
+    {
+        return columns + "," + prefix + "qw," + prefix + "qx," + prefix + "qy," + prefix + "qz";
+    }
+    return columns + ",NULL,NULL,NULL,NULL";
+}
+
+ShapeStorage::BoundingShapeStorer ShapeStorage::CreateBoundingShapeStorer(SQLite::DB& db, const int64_t firstId)
+{
+    if (!HasOrientationColumns(db))
+    {
+        for (const char* column : { "qw","qx","qy","qz" })
+        {
+            db.ExecDML("ALTER TABLE BoundingShapes ADD COLUMN %1% FLOAT", column);
+        }
+    }
+    SQLite::Statement boundingShapeStatement = db.CompileStatement("INSERT INTO BoundingShapes(Id,Type,x0,y0,z0,x1,y1,z1,Radius,Optimal,qw,qx,qy,qz) VALUES(?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,?11,?12,?13,?14)");
+    int64_t boundingShapeCount = firstId;
+    return [boundingShapeStatement,boundingShapeCount](const BoundingShape3d& bs) mutable -> int64_t
     {
         if (bs.GetType() == BoundingShape3d::Type::Unknown)
         {
@@ -318,7 +830,11 @@ void Shape::Store(SQLite::DB& db) const
         boundingShapeStatement.Reset();
         boundingShapeStatement.Bind(1, boundingShapeCount);
         boundingShapeStatement.Bind(2, BoundingShapeType::Convert(bs.GetType()));
-        Vertex p0;
+        Vector3d p0;
+        for (int i = 11; i <= 14; ++i)
+        {
+            boundingShapeStatement.BindNull(i);
+        }
         if (bs.GetType() == BoundingShape3d::Type::Ball)
         {
             p0 = bs.GetCenter();
@@ -327,10 +843,24 @@ void Shape::Store(SQLite::DB& db) const
             boundingShapeStatement.BindNull(8);
             boundingShapeStatement.Bind(9,bs.GetRadius());
         }
+        else if (bs.GetType() == BoundingShape3d::Type::OrientedBox)
+        {
+            p0 = bs.GetCenter();
+            Vector3d p1 = bs.GetHalfExtents();
+            boundingShapeStatement.Bind(6, p1[0]);
+            boundingShapeStatement.Bind(7, p1[1]);
+            boundingShapeStatement.Bind(8, p1[2]);
+            boundingShapeStatement.BindNull(9);
+            const Quat rotation = AxesToRotation(bs.GetAxes());
+            for (int i = 0; i < 4; ++i)
+            {
+                boundingShapeStatement.Bind(11 + i, rotation.GetWXYZ()[i]);
+            }
+        }
         else
         {
             p0 = bs.GetMin();
-            Vertex p1 = bs.GetMax();
+            Vector3d p1 = bs.GetMax();
             boundingShapeStatement.Bind(6, p1[0]);
             boundingShapeStatement.Bind(7, p1[1]);
             boundingShapeStatement.Bind(8, p1[2]);
@@ -343,110 +873,397 @@ void Shape::Store(SQLite::DB& db) const
         boundingShapeStatement.ExecDML();
         return boundingShapeCount++;
     };
+}
+
+BoundingShape3d ShapeStorage::GetBoundingShape(const SQLite::Query& query, const int firstField)
+{
+    BoundingShape3d bs;
+    BoundingShape3d::Type type = BoundingShapeType::Convert(query.GetInt64Field(firstField));
+    if (type != BoundingShape3d::Type::Unknown)
+    {
+        Vector3d p0(query.GetFloatField(firstField + 1), query.GetFloatField(firstField + 2), query.GetFloatField(firstField + 3));
+        bool optimal = (0 != query.GetInt64Field(firstField + 8));
+        if (type == BoundingShape3d::Type::Ball)
+        {
+            double radius = query.GetFloatField(firstField + 7);
+            bs.Set(p0, radius, optimal);
+        }
+        else if (type == BoundingShape3d::Type::OrientedBox)
+        {
+            Vector3d halfExtents(query.GetFloatField(firstField + 4), query.GetFloatField(firstField + 5), query.GetFloatField(firstField + 6));
+            Quat rotation(query.GetFloatField(firstField + 9), query.GetFloatField(firstField + 10), query.GetFloatField(firstField + 11), query.GetFloatField(firstField + 12));
+            bs.Set(p0, RotationToAxes(rotation), halfExtents, optimal);
+        }
+        else
+        {
+            Vector3d p1(query.GetFloatField(firstField + 4), query.GetFloatField(firstField + 5), query.GetFloatField(firstField + 6));
+            bs.Set(p0, p1, optimal);
+        }
+    }
+    return bs;
+}
+
+// version 2 layout: per hull, the ShapeFormat arrays are stored as blobs (native/little endian)
+const char* ShapeStorage::HullsInsert = "INSERT INTO Hulls(Id,Shape,Orientation,Color,BoundingShape,Vertices,Normals,TextureCoords,Colors,Edges,Faces) VALUES(?1,?11,?2,?3,?4,?5,?6,?7,?8,?9,?10)";
+const char* ShapeStorage::HullsColumns = "Id,Orientation,Color,BoundingShape,Vertices,Normals,TextureCoords,Colors,Edges,Faces";
+
+void ShapeStorage::CreateHullsTable(SQLite::DB& db)
+{
+    db.ExecDML("CREATE TABLE Hulls(Id INTEGER PRIMARY KEY,Shape INTEGER,Orientation INTEGER,Color INTEGER,BoundingShape INTEGER,Vertices BLOB,Normals BLOB,TextureCoords BLOB,Colors BLOB,Edges BLOB,Faces BLOB)");
+}
+
+void ShapeStorage::InsertHull(SQLite::Statement& s, const int64_t id, const int64_t shapeId, const HullRaw& hull, const BoundingShape3d& boundingShape, const BoundingShapeStorer& StoreBoundingShape)
+{
+    const ShapeFormat::Arrays arrays = ShapeFormat::Pack({ hull });
+    s.Reset();
+    s.Bind(1, id);
+    s.Bind(2, Orientation::Convert(hull->GetOrientation()));
+    s.Bind(3, (int64_t)(hull->GetColor() ? hull->GetColor()->GetInt() : -1));
+    s.Bind(4, StoreBoundingShape(boundingShape));
+    BindBlob(s, 5, arrays.m_vertices);
+    BindBlob(s, 6, arrays.m_normals);
+    BindBlob(s, 7, arrays.m_textureCoords);
+    BindBlob(s, 8, arrays.m_colors);
+    BindBlob(s, 9, arrays.m_edges);
+    BindBlob(s, 10, arrays.m_faces);
+    s.Bind(11, shapeId);
+    s.ExecDML();
+}
 
-    // Header
-    db.ExecDML("DROP TABLE IF EXISTS Header");
-    db.ExecDML("CREATE TABLE Header(Key TEXT PRIMARY KEY,Value) WITHOUT ROWID");
-    db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Type','Shape')");
-    db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Version',%1%)", SerializationVersion);
+ShapeFormat::Arrays ShapeStorage::GetHullArrays(const SQLite::Query& query, const BoundingShape3d& boundingShape)
+{
+    ShapeFormat::Arrays arrays;
+    GetBlob(query, 4, arrays.m_vertices);
+    GetBlob(query, 5, arrays.m_normals);
+    GetBlob(query, 6, arrays.m_textureCoords);
+    GetBlob(query, 7, arrays.m_colors);
+    GetBlob(query, 8, arrays.m_edges);
+    GetBlob(query, 9, arrays.m_faces);
 
-    // Normals
-    StoreVectorMap(db, normals, "Normals");
+    ShapeFormat::PackedHull packedHull;
+    packedHull.m_firstFace = 0;
+    packedHull.m_faceCount = (uint32_t)arrays.m_faces.size();
+    packedHull.m_orientation = Orientation::Convert(query.GetInt64Field(1)) == Hull::Orientation::Inward ? 1 : 0;
+    packedHull.m_color = ShapeFormat::NoIndex;
+    int64_t color = query.GetInt64Field(2);
+    if (color != -1)
+    {
+        packedHull.m_color = (uint32_t)arrays.m_colors.size();
+        arrays.m_colors.emplace_back((uint32_t)color);
+    }
+    packedHull.m_boundingShape = ShapeFormat::Pack(boundingShape);
+    arrays.m_hulls.emplace_back(packedHull);
+    return arrays;
+}
 
-    // Vertices
-    StoreVectorMap(db, vertices, "Vertices");
+bool Shape::CanStoreDelta(SQLite::DB& db) const
+{
+    if (m_storeToken.empty() || !db.TableExists("Header"))
+    {
+        return false;
+    }
+    SQLite::Query query = db.ExecQueryParams("SELECT Value FROM Header WHERE Key=?1", "StoreToken");
+    return !query.IsEOF() && query.GetStringField(0) == m_storeToken;
+}
 
-    // TextureCoords
-    StoreVectorMap(db, textureCoords, "TextureCoords");
+void Shape::Store(SQLite::DB& db, const StorageMode mode) const
+{
+    GEOMETRY_PROFILE_SCOPE("Shape::Store");
+    // the shape's own hulls and, in the same order, what to store for them
+    std::vector<HullRaw> hulls;
+    ForEachHull([&hulls](const HullRaw& hull) { hulls.emplace_back(hull); });
+    Shape materialized;
+    std::vector<HullRaw> storedHulls = GetMaterializedHulls(materialized);
 
-    // Edges
-    db.ExecDML("DROP TABLE IF EXISTS Edges");
-    db.ExecDML("CREATE TABLE Edges(Id INTEGER PRIMARY KEY,Vertex INTEGER,Normal INTEGER,Face INTEGER,Twin INTEGER,Next INTEGER,Prev INTEGER,Color INTEGER,TextureCoord INTEGER) WITHOUT ROWID");
-    SQLite::Statement s = db.CompileStatement("INSERT INTO Edges(Id,Vertex,Normal,Face,Twin,Next,Prev,Color,TextureCoord) VALUES(?1,?2,?3,?4,?5,?6,?7,?8,?9)");
-    for (auto& edge : edges)
+    // don't store a broken shape; the checksum allows Retrieve to verify what it reads
+    Hull::ValidationReport report = {};
+    for (const HullRaw& hull : storedHulls)
     {
-        if (edge.first)
+        report.Merge(hull->Validate());
+    }
+    report.Check("Invalid shape");
+    std::vector<int64_t> ids(hulls.size(), 0);
+    GEOMETRY_PROFILE_ELEMENTS(hulls.size());
+
+    // journal_mode and synchronous can't be changed inside a transaction
+    std::unique_ptr<BulkPragmas> pragmas;
+    if (mode == StorageMode::BulkRows)
+    {
+        pragmas = std::make_unique<BulkPragmas>(db);
+    }
+
+    // All work within one transaction
+    const std::string storeToken = (mode == StorageMode::Blobs || mode == StorageMode::Delta) ? NewStoreToken() : "";
+    db.BeginTransaction();
+    try
+    {
+        const bool delta = (mode == StorageMode::Delta) && CanStoreDelta(db);
+
+        // prepare for storing BoundingShapes
+        int64_t boundingShapeCount = 1;
+        if (delta)
+        {
+            boundingShapeCount = db.ExecSingleInt64("SELECT MAX(Id) FROM BoundingShapes") + 1;
+        }
+        else
         {
+            db.ExecDML("DROP TABLE IF EXISTS BoundingShapes");
+            CreateBoundingShapesTable(db);
+        }
+        const BoundingShapeStorer StoreBoundingShape = CreateBoundingShapeStorer(db, boundingShapeCount);
+
+        if (delta)
+        {
+            db.ExecDMLParams("UPDATE Header SET Value=?1 WHERE Key='StoreToken'", storeToken);
+            db.ExecDMLParams("INSERT OR REPLACE INTO Header(Key,Value) VALUES('Checksum',?1)", (int64_t)report.m_checksum);
+
+            // Hulls
+            StoreBlobsDelta(db, hulls, storedHulls, StoreBoundingShape, ids);
+
+            // Shape
+            db.ExecDML("DELETE FROM BoundingShapes WHERE Id<>0 AND Id IN (SELECT BoundingShape FROM Shapes)");
+            db.ExecDMLParams("UPDATE Shapes SET BoundingShape=?1 WHERE Id=0", StoreBoundingShape(GetBoundingShape()));
+        }
+        else
+        {
+            // Header
+            db.ExecDML("DROP TABLE IF EXISTS Header");
+            db.ExecDML("CREATE TABLE Header(Key TEXT PRIMARY KEY,Value) WITHOUT ROWID");
+            db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Type','Shape')");
+            db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Version',%1%)", storeToken.empty() ? RowsSerializationVersion : SerializationVersion);
+            if (!storeToken.empty())
+            {
+                db.ExecDMLParams("INSERT INTO Header(Key,Value) VALUES('StoreToken',?1)", storeToken);
+            }
+            db.ExecDMLParams("INSERT INTO Header(Key,Value) VALUES('Checksum',?1)", (int64_t)report.m_checksum);
+
+            // remove the tables of a previously stored shape
+            for (const char* table : { "Normals", "Vertices", "TextureCoords", "Edges", "Faces", "Hulls" })
+            {
+                db.ExecDML("DROP TABLE IF EXISTS %1%", table);
+            }
+
+            // Hulls
+            switch (mode)
+            {
+            case StorageMode::Rows:
+            case StorageMode::BulkRows:
+                StoreRows(db, storedHulls, StoreBoundingShape, mode == StorageMode::BulkRows);
+                break;
+            default:
+                assert(false); // unknown storage mode
+            case StorageMode::Blobs:
+            case StorageMode::Delta:
+                StoreBlobs(db, storedHulls, StoreBoundingShape, ids);
+                break;
+            }
+
+            // Shape
+            db.ExecDML("DROP TABLE IF EXISTS Shapes");
+            db.ExecDML("CREATE TABLE Shapes(Id INTEGER PRIMARY KEY,BoundingShape INTEGER) WITHOUT ROWID");
+            SQLite::Statement s = db.CompileStatement("INSERT INTO Shapes(Id,BoundingShape) VALUES(?1,?2)");
             s.Reset();
-            s.Bind(1, (int64_t)edge.second);
-            s.Bind(2, (int64_t)vertices[edge.first->GetStartVertex()]);
-            s.Bind(3, (int64_t)normals[edge.first->GetStartNormal()]);
-            s.Bind(4, (int64_t)faces[edge.first->GetFace()]);
-            s.Bind(5, (int64_t)edges[edge.first->GetTwin()]);
-            s.Bind(6, (int64_t)edges[edge.first->GetNext()]);
-            s.Bind(7, (int64_t)edges[edge.first->GetPrev()]); // not needed?
-            s.Bind(8, (int64_t)(edge.first->GetStartColor()?edge.first->GetStartColor()->GetInt():-1));
-            s.Bind(9, (int64_t)textureCoords[edge.first->GetStartTextureCoord()]);
+            s.Bind(1, (int64_t)0);
+            s.Bind(2, StoreBoundingShape(GetBoundingShape()));
             s.ExecDML();
         }
+
+        // End transaction
+        db.CommitTransaction();
     }
+    catch (...)
+    {
+        db.RollbackTransaction();
+        throw;
+    }
+
+    // remember what is in the db now
+    m_storeToken = storeToken;
+    for (size_t i = 0; i < hulls.size(); ++i)
+    {
+        hulls[i]->SetStored(ids[i]);
+    }
+}
+
+void Shape::Retrieve(SQLite::DB& db, RetrieveTimings* timings)
+{
+    GEOMETRY_PROFILE_SCOPE("Shape::Retrieve");
+    const Clock::time_point start = Clock::now();
+    RetrieveTimings localTimings = {};
+    std::unordered_map<size_t,BoundingShape3d> boundingShapes;
 
-    // Faces
-    db.ExecDML("DROP TABLE IF EXISTS Faces");
-    db.ExecDML("CREATE TABLE Faces(Id INTEGER PRIMARY KEY,Hull INTEGER,Normal INTEGER,Color INTEGER) WITHOUT ROWID");
-    s = db.CompileStatement("INSERT INTO Faces(Id,Hull,Normal,Color) VALUES(?1,?2,?3,?4)");
-    for (auto& face : faces)
+    Clear();
+
+    // All work within one transaction; a failure leaves the shape empty
+    bool hasChecksum = false;
+    uint64_t checksum = 0;
+    db.BeginTransaction();
+    try
     {
-        if (face.first)
+        // Check Header
+        string type = db.ExecSingleString("SELECT Value FROM Header WHERE Key='Type'");
+        int64_t serializationVersion = db.ExecSingleInt64("SELECT Value FROM Header WHERE Key='Version'");
+        if (type != "Shape" || serializationVersion < RowsSerializationVersion || serializationVersion > SerializationVersion)
         {
-            s.Reset();
-            s.Bind(1, (int64_t)face.second);
-            s.Bind(2, (int64_t)hulls[face.first->GetHull()]);
-            s.Bind(3, (int64_t)normals[face.first->GetNormal()]);
-            s.Bind(4, (int64_t)(face.first->GetColor()?face.first->GetColor()->GetInt():-1));
-            s.ExecDML();
+            throw std::runtime_error("Not a (supported) shape database");
+        }
+
+        // Retrieve BoundingShapes
+        SQLite::Query query = db.ExecQuery("SELECT Id,%1% FROM BoundingShapes", BoundingShapeColumns(db, ""));
+        for (; !query.IsEOF(); query.NextRow())
+        {
+            boundingShapes.emplace(query.GetInt64Field(0), ShapeStorage::GetBoundingShape(query, 1));
         }
+
+        // Shape
+        query = db.ExecQuery("SELECT Id,BoundingShape FROM Shapes");
+        SetBoundingShape(boundingShapes[query.GetInt64Field(1)]);
+        query.Finalize();
+        localTimings.m_header = ElapsedMs(start);
+
+        if (serializationVersion == RowsSerializationVersion)
+        {
+            RetrieveRows(db, boundingShapes, localTimings);
+        }
+        else
+        {
+            RetrieveBlobs(db, boundingShapes, localTimings);
+            query = db.ExecQueryParams("SELECT Value FROM Header WHERE Key=?1", "StoreToken");
+            m_storeToken = query.IsEOF() ? "" : query.GetStringField(0);
+            query.Finalize();
+        }
+        query = db.ExecQueryParams("SELECT Value FROM Header WHERE Key=?1", "Checksum");
+        hasChecksum = !query.IsEOF();
+        checksum = hasChecksum ? (uint64_t)query.GetInt64Field(0) : 0;
+        query.Finalize();
+
+        // End transaction
+        db.CommitTransaction();
+    }
+    catch (...)
+    {
+        db.RollbackTransaction();
+        Clear();
+        throw;
     }
 
-    // Hulls
-    db.ExecDML("DROP TABLE IF EXISTS Hulls");
-    db.ExecDML("CREATE TABLE Hulls(Id INTEGER PRIMARY KEY,Shape INTEGER,Orientation INTEGER,Color INTEGER,BoundingShape INTEGER) WITHOUT ROWID");
-    s = db.CompileStatement("INSERT INTO Hulls(Id,Shape,Orientation,Color,BoundingShape) VALUES(?1,0,?2,?3,?4)");
-    for (auto& hull : hulls)
+    // check the result
+    const Clock::time_point checkStart = Clock::now();
+    const Hull::ValidationReport report = Validate();
+    if (!report.IsValid() || (hasChecksum && checksum != report.m_checksum))
+    {
+        Clear();
+        report.Check("Corrupt shape database");
+        throw std::runtime_error("Corrupt shape database: checksum mismatch");
+    }
+    localTimings.m_check = ElapsedMs(checkStart);
+    GEOMETRY_PROFILE_ELEMENTS(GetHulls().size());
+
+    localTimings.m_total = ElapsedMs(start);
+    if (timings)
+    {
+        *timings = localTimings;
+    }
+}
+
+void Shape::RetrieveBlobs(SQLite::DB& db, std::unordered_map<size_t, BoundingShape3d>& boundingShapes, RetrieveTimings& timings)
+{
+    // Pipeline: the reader thread fetches the blobs of the next hulls while this thread builds the current one
+    const size_t maxQueued = 4;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // the hull arrays only hold the packed bounding shape, which can't hold an oriented box
+    struct QueuedHull
     {
-        if (hull.first)
+        int64_t m_id;
+        BoundingShape3d m_boundingShape;
+        ShapeFormat::Arrays m_arrays;
+    };
+    std::deque<QueuedHull> queue;
+    bool done = false;
+    bool abort = false;
+    std::exception_ptr readError;
+
+    std::thread reader([&]()
+    {
+        const Clock::time_point start = Clock::now();
+        try
         {
-            s.Reset();
-            s.Bind(1, (int64_t)hull.second);
-            s.Bind(2, Orientation::Convert(hull.first->GetOrientation()));
-            s.Bind(3, (int64_t)(hull.first->GetColor() ? hull.first->GetColor()->GetInt() : -1));
-            s.Bind(4, StoreBoundingShape(hull.first->GetBoundingShape()));
-            s.ExecDML();
+            SQLite::Query query = db.ExecQuery("SELECT %1% FROM Hulls ORDER BY Id", HullsColumns);
+            for (; !query.IsEOF(); query.NextRow())
+            {
+                const BoundingShape3d& boundingShape = boundingShapes[query.GetInt64Field(3)];
+                ShapeFormat::Arrays arrays = GetHullArrays(query, boundingShape);
+
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return queue.size() < maxQueued || abort; });
+                if (abort)
+                {
+                    break;
+                }
+                queue.push_back({ query.GetInt64Field(0), boundingShape, std::move(arrays) });
+                changed.notify_all();
+            }
         }
-    }
+        catch (...)
+        {
+            readError = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        timings.m_read = ElapsedMs(start);
+        done = true;
+        changed.notify_all();
+    });
 
-    // Shape
-    db.ExecDML("DROP TABLE IF EXISTS Shapes");
-    db.ExecDML("CREATE TABLE Shapes(Id INTEGER PRIMARY KEY,BoundingShape INTEGER) WITHOUT ROWID");
-    s = db.CompileStatement("INSERT INTO Shapes(Id,BoundingShape) VALUES(?1,?2)");
-    s.Reset();
-    s.Bind(1, (int64_t)0);
-    s.Bind(2, StoreBoundingShape(GetBoundingShape()));
-    s.ExecDML();
+    const Clock::time_point start = Clock::now();
+    double waiting = 0;
+    try
+    {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            const Clock::time_point waitStart = Clock::now();
+            changed.wait(lock, [&]() { return !queue.empty() || done; });
+            waiting += ElapsedMs(waitStart);
+            if (queue.empty())
+            {
+                break;
+            }
+            QueuedHull queued = std::move(queue.front());
+            queue.pop_front();
+            changed.notify_all();
+            lock.unlock();
 
-    // End transaction
-    db.CommitTransaction();
+            for (const HullRaw& hull : ShapeFormat::Unpack(ShapeFormat::GetView(queued.m_arrays), *this))
+            {
+                hull->SetBoundingShape(queued.m_boundingShape);
+                hull->SetStored(queued.m_id);
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            abort = true;
+            changed.notify_all();
+        }
+        reader.join();
+        throw;
+    }
+    reader.join();
+    timings.m_build = ElapsedMs(start) - waiting;
+    if (readError)
+    {
+        std::rethrow_exception(readError);
+    }
 }
 
-void Shape::Retrieve(SQLite::DB& db)
+void Shape::RetrieveRows(SQLite::DB& db, std::unordered_map<size_t, BoundingShape3d>& boundingShapes, RetrieveTimings& timings)
 {
     std::unordered_map<size_t,HullPtr> hulls;
     std::unordered_map<size_t,EdgePtr> edges;
-    std::unordered_map<size_t,VertexPtr> vertices;
-    std::unordered_map<size_t,NormalPtr> normals;
-    std::unordered_map<size_t,TextureCoordPtr> textureCoords;
     std::unordered_map<size_t,FacePtr> faces;
-    std::unordered_map<size_t,BoundingShape3d> boundingShapes;
-
-    Clear();
-
-    // All work within one transaction
-    db.BeginTransaction();
-
-    // Check Header
-    string type = db.ExecSingleString("SELECT Value FROM Header WHERE Key='Type'");
-    int64_t serializationVersion = db.ExecSingleInt64("SELECT Value FROM Header WHERE Key='Version'");
-    // TODO: check type and serializationVersion
 
     // Keep track of assigned colors
     std::unordered_map<int64_t, ColorPtr> colors;
@@ -461,99 +1278,145 @@ void Shape::Retrieve(SQLite::DB& db)
         return iter->second;
     };
 
-    // Retrieve BoundingShapes
-    SQLite::Query query = db.ExecQuery("SELECT Id,Type,x0,y0,z0,x1,y1,z1,Radius,Optimal FROM BoundingShapes");
-    for (; !query.IsEOF(); query.NextRow())
+    // Pipeline: a reader thread decodes the tables one after the other while this thread builds the objects of the
+    // tables which are done. The reader uses the connection of Retrieve, so it reads within the same transaction
+    // (one snapshot of the db) and works for in-memory dbs too; this thread doesn't use the connection meanwhile.
+    std::promise<std::vector<HullRow>> hullRows;
+    std::promise<std::unordered_map<size_t, NormalPtr>> normalsRead;
+    std::promise<std::vector<FaceRow>> faceRows;
+    std::promise<std::unordered_map<size_t, VertexPtr>> verticesRead;
+    std::promise<std::vector<EdgeRow>> edgeRows;
+    std::promise<std::unordered_map<size_t, TextureCoordPtr>> textureCoordsRead;
+    auto hullsFuture = hullRows.get_future();
+    auto normalsFuture = normalsRead.get_future();
+    auto facesFuture = faceRows.get_future();
+    auto verticesFuture = verticesRead.get_future();
+    auto edgesFuture = edgeRows.get_future();
+    auto textureCoordsFuture = textureCoordsRead.get_future();
+
+    const Clock::time_point readStart = Clock::now();
+    std::thread reader([&]()
     {
-        BoundingShape3d bs;
-        int64_t Id = query.GetInt64Field(0);
-        BoundingShape3d::Type type = BoundingShapeType::Convert(query.GetInt64Field(1));
-        if (type != BoundingShape3d::Type::Unknown)
+        try
         {
-            Vertex p0(query.GetFloatField(2), query.GetFloatField(3), query.GetFloatField(4));
-            bool optimal = (0 != query.GetInt64Field(9));
-            if (type == BoundingShape3d::Type::Ball)
+            Produce<std::vector<HullRow>>(hullRows, [&db]()
             {
-                double radius = query.GetFloatField(8);
-                bs.Set(p0, radius, optimal);
-            }
-            else
+                return ReadRows<HullRow>(db, "SELECT Id,Orientation,Color,BoundingShape FROM Hulls", [](const SQLite::Query& query)
+                {
+                    return HullRow{ query.GetInt64Field(0), query.GetIntField(1), query.GetInt64Field(2), query.GetInt64Field(3) };
+                });
+            });
+            Produce<std::unordered_map<size_t, NormalPtr>>(normalsRead, [&db]() { return ReadVectorTable<Normal>(db, "Normals"); });
+            Produce<std::vector<FaceRow>>(faceRows, [&db]()
             {
-                Vertex p1(query.GetFloatField(5), query.GetFloatField(6), query.GetFloatField(7));
-                bs.Set(p0, p1, optimal);
-            }
-        }       
-        boundingShapes.emplace(Id, bs);
-    }
-
-    // Read vertices
-    ReadVectorMap(db, vertices, "Vertices");
+                return ReadRows<FaceRow>(db, "SELECT Id,Hull,Normal,Color FROM Faces", [](const SQLite::Query& query)
+                {
+                    return FaceRow{ query.GetInt64Field(0), query.GetInt64Field(1), query.GetInt64Field(2), query.GetInt64Field(3) };
+                });
+            });
+            Produce<std::unordered_map<size_t, VertexPtr>>(verticesRead, [&db]() { return ReadVectorTable<Vertex>(db, "Vertices"); });
+            Produce<std::vector<EdgeRow>>(edgeRows, [&db]()
+            {
+                return ReadRows<EdgeRow>(db, "SELECT Id,Vertex,Normal,Face,Twin,Next,Prev,Color,TextureCoord FROM Edges", [](const SQLite::Query& query)
+                {
+                    return EdgeRow{ query.GetInt64Field(0), query.GetInt64Field(1), query.GetInt64Field(2), query.GetInt64Field(3),
+                        query.GetInt64Field(4), query.GetInt64Field(5), query.GetInt64Field(6), query.GetInt64Field(7), query.GetInt64Field(8) };
+                });
+            });
+            Produce<std::unordered_map<size_t, TextureCoordPtr>>(textureCoordsRead, [&db]() { return ReadVectorTable<TextureCoord>(db, "TextureCoords"); });
+        }
+        catch (...)
+        {
+            // passed on by the future of the table which failed; the tables after it aren't waited for
+        }
+        timings.m_read = ElapsedMs(readStart);
+    });
 
-    // Read normals
-    ReadVectorMap(db, normals, "Normals");
+    double waiting = 0;
+    auto Wait = [&waiting](auto& future)
+    {
+        const Clock::time_point waitStart = Clock::now();
+        auto res = future.get();
+        waiting += ElapsedMs(waitStart);
+        return res;
+    };
 
-    // Read textureCoords
-    ReadVectorMap(db, textureCoords, "TextureCoords");
+    const Clock::time_point buildStart = Clock::now();
+    std::vector<EdgeRow> links;
+    std::unordered_map<size_t, TextureCoordPtr> textureCoords;
+    try
+    {
+        // Hulls
+        for (const HullRow& row : Wait(hullsFuture))
+        {
+            auto hull = ConstructAndAddHull();
+            hull->SetOrientation(Orientation::Convert(row.m_orientation));
+            hull->SetColor(ColorFromId(row.m_color));
+            hull->SetBoundingShape(boundingShapes[(size_t)row.m_boundingShape]);
+            hulls.emplace(row.m_id, hull);
+        }
 
-    // Shape
-    query = db.ExecQuery("SELECT Id,BoundingShape FROM Shapes");
-    SetBoundingShape(boundingShapes[query.GetInt64Field(1)]);
+        // Faces
+        const std::unordered_map<size_t, NormalPtr> normals = Wait(normalsFuture);
+        for (const FaceRow& row : Wait(facesFuture))
+        {
+            auto face = hulls[row.m_hull]->ConstructAndAddFace();
+            face->SetNormal(FindOrNull(normals, (size_t)row.m_normal));
+            face->SetColor(ColorFromId(row.m_color));
+            faces.emplace(row.m_id, face);
+        }
 
-    // Hulls
-    query = db.ExecQuery("SELECT Id,Orientation,Color,BoundingShape FROM Hulls");
-    for (; !query.IsEOF(); query.NextRow())
-    {
-        int64_t Id = query.GetInt64Field(0);
-        auto hull = ConstructAndAddHull();
-        hull->SetOrientation(Orientation::Convert(query.GetIntField(1)));
-        hull->SetColor(ColorFromId(query.GetInt64Field(2)));
-        hull->SetBoundingShape(boundingShapes[query.GetInt64Field(3)]);
-        hulls.emplace(Id, hull);
+        // Edges
+        // First add the edges, then fill the relation with others
+        const std::unordered_map<size_t, VertexPtr> vertices = Wait(verticesFuture);
+        links = Wait(edgesFuture);
+        for (const EdgeRow& row : links)
+        {
+            auto& vertex = FindOrNull(vertices, (size_t)row.m_vertex);
+            auto& normal = FindOrNull(normals, (size_t)row.m_normal);
+            auto edge = faces[row.m_face]->ConstructAndAddEdge(vertex, normal);
+            edges.emplace(row.m_id, edge);
+        }
+        textureCoords = Wait(textureCoordsFuture);
     }
-
-    // Faces
-    query = db.ExecQuery("SELECT Id,Hull,Normal,Color FROM Faces");
-    for (; !query.IsEOF(); query.NextRow())
+    catch (...)
     {
-        int64_t Id = query.GetInt64Field(0);
-        int64_t hullId = query.GetInt64Field(1);
-        auto face = hulls[hullId]->ConstructAndAddFace();
-        face->SetNormal(normals[query.GetInt64Field(2)]);
-        face->SetColor(ColorFromId(query.GetInt64Field(3)));
-        faces.emplace(Id, face);
+        reader.join();
+        throw;
     }
+    reader.join();
+    timings.m_build = ElapsedMs(buildStart) - waiting;
 
-    // Edges   
-    // First add the edges, then fill the relation with others
-    query = db.ExecQuery("SELECT Id,Vertex,Normal,Face FROM Edges");
-    for (; !query.IsEOF(); query.NextRow())
+    // Link the edges in parallel; every edge is only changed by one thread and the maps are read-only by now
+    const Clock::time_point linkStart = Clock::now();
+    for (const auto& link : links)
     {
-        int64_t Id = query.GetInt64Field(0);
-        auto& vertex = vertices[query.GetInt64Field(1)];
-        auto& normal = normals[query.GetInt64Field(2)];
-        int64_t faceId = query.GetInt64Field(3);
-        auto edge = faces[faceId]->ConstructAndAddEdge(vertex,normal);
-        edges.emplace(Id, edge);
+        ColorFromId(link.m_color);
     }
-    query = db.ExecQuery("SELECT Id,Twin,Next,Prev,Color,TextureCoord FROM Edges");
-    for (; !query.IsEOF(); query.NextRow())
+    ParallelFor(links.size(), [&](size_t begin, size_t end)
     {
-        auto& edge = edges[query.GetInt64Field(0)];
-        auto& twin = edges[query.GetInt64Field(1)];
-        auto& next = edges[query.GetInt64Field(2)];
-        auto& prev = edges[query.GetInt64Field(3)];
-        edge->SetTwin(twin);
-        edge->SetNext(next);
-        edge->SetPrev(prev);
-        edge->SetStartColor(ColorFromId(query.GetInt64Field(4)));
-        edge->SetStartTextureCoord(textureCoords[query.GetInt64Field(5)]);
-    }
-
-    // End transaction
-    db.CommitTransaction();
+        for (size_t i = begin; i < end; ++i)
+        {
+            const EdgeRow& link = links[i];
+            const EdgePtr& edge = FindOrNull(edges, (size_t)link.m_id);
+            edge->SetTwin(FindOrNull(edges, (size_t)link.m_twin));
+            edge->SetNext(FindOrNull(edges, (size_t)link.m_next));
+            edge->SetPrev(FindOrNull(edges, (size_t)link.m_prev));
+            edge->SetStartColor(FindOrNull(colors, link.m_color));
+            edge->SetStartTextureCoord(FindOrNull(textureCoords, (size_t)link.m_textureCoord));
+        }
+    });
+    timings.m_link = ElapsedMs(linkStart);
+}
 
-    // check the result
-    ForEachFace([](const FaceRaw& face) {face->CheckPointering(); });
+Hull::ValidationReport Shape::Validate() const
+{
+    Hull::ValidationReport report = {};
+    ForEachHull([&report](const HullRaw& hull)
+    {
+        report.Merge(hull->Validate());
+    });
+    return report;
 }
 
 double Shape::CalculateVolume() const
@@ -576,6 +1439,8 @@ double Shape::CalculateVolume() const
 
 void Shape::Add(ShapePtr & other)
 {
+    GEOMETRY_PROFILE_SCOPE("Shape::Add");
+    GEOMETRY_PROFILE_ELEMENTS(GetHulls().size() + other->GetHulls().size());
     std::vector<HullPtr> A(GetHulls().begin(), GetHulls().end());
     std::vector<HullPtr> B(other->GetHulls().begin(), other->GetHulls().end());
 
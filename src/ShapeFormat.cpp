@@ -0,0 +1,489 @@
+#include "Geometry.h"
+using namespace std;
+using namespace Geometry;
+using namespace Geometry::ShapeFormat;
+
+PackedBoundingShape ShapeFormat::Pack(const BoundingShape3d& boundingShape)
+{
+    PackedBoundingShape packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.m_optimal = boundingShape.IsOptimal() ? 1 : 0;
+    switch (boundingShape.GetType())
+    {
+    default:
+        assert(false); // wickedly wrong type value!
+    case BoundingShape3d::Type::Unknown:
+        packed.m_type = PackedBoundingShape::Unknown;
+        packed.m_optimal = 0;
+        break;
+    case BoundingShape3d::Type::Ball:
+        {
+            packed.m_type = PackedBoundingShape::Ball;
+            Vector3d center = boundingShape.GetCenter();
+            for (int i = 0; i < 3; ++i)
+            {
+                packed.m_p0.m_data[i] = center[i];
+            }
+            packed.m_radius = boundingShape.GetRadius();
+        }
+        break;
+    case BoundingShape3d::Type::Box:
+        {
+            packed.m_type = PackedBoundingShape::Box;
+            Vector3d p0 = boundingShape.GetMin();
+            Vector3d p1 = boundingShape.GetMax();
+            for (int i = 0; i < 3; ++i)
+            {
+                packed.m_p0.m_data[i] = p0[i];
+                packed.m_p1.m_data[i] = p1[i];
+            }
+        }
+        break;
+    case BoundingShape3d::Type::OrientedBox:
+        {
+            // no room for the orientation, store the enclosing box
+            BoundingShape3d box = boundingShape;
+            box.Convert(BoundingShape3d::Type::Box);
+            return Pack(box);
+        }
+    }
+    return packed;
+}
+
+BoundingShape3d ShapeFormat::Unpack(const PackedBoundingShape& boundingShape)
+{
+    const auto& p0 = boundingShape.m_p0.m_data;
+    const auto& p1 = boundingShape.m_p1.m_data;
+    const bool optimal = (0 != boundingShape.m_optimal);
+    switch (boundingShape.m_type)
+    {
+    case PackedBoundingShape::Ball:
+        return BoundingShape3d(Vector3d(p0[0], p0[1], p0[2]), boundingShape.m_radius, optimal);
+    case PackedBoundingShape::Box:
+        return BoundingShape3d(Vector3d(p0[0], p0[1], p0[2]), Vector3d(p1[0], p1[1], p1[2]), optimal);
+    default:
+        return BoundingShape3d();
+    }
+}
+
+namespace
+{
+    uint64_t Align(const uint64_t offset)
+    {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+
+    // Assigns consecutive indices to pointers in order of first appearance
+    template<typename T>
+    class Indexer
+    {
+    public:
+        uint32_t operator () (const T& t)
+        {
+            if (!t)
+            {
+                return NoIndex;
+            }
+            auto res = m_indices.emplace(t, (uint32_t)m_items.size());
+            if (res.second)
+            {
+                m_items.emplace_back(t);
+            }
+            return res.first->second;
+        }
+        uint32_t Find(const T& t) const
+        {
+            auto iter = m_indices.find(t);
+            return m_indices.end() == iter ? NoIndex : iter->second;
+        }
+        const std::vector<T>& GetItems() const { return m_items; }
+    private:
+        std::unordered_map<T, uint32_t> m_indices;
+        std::vector<T> m_items;
+    };
+
+    template<typename PACKED, typename T>
+    std::vector<PACKED> PackVectors(const std::vector<T>& items)
+    {
+        std::vector<PACKED> packed(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            for (unsigned int j = 0; j < T::element_type::dimension; ++j)
+            {
+                packed[i].m_data[j] = (*items[i])[j];
+            }
+        }
+        return packed;
+    }
+
+    class Writer
+    {
+    public:
+        Writer(std::ostream& stream)
+            : m_stream(stream)
+            , m_position(0)
+        {}
+
+        template<typename T>
+        static void Layout(Section& section, uint64_t& offset, const std::vector<T>& items)
+        {
+            section.m_offset = Align(offset);
+            section.m_count = items.size();
+            offset = section.m_offset + section.m_count * sizeof(T);
+        }
+
+        void Write(const void* data, const uint64_t size)
+        {
+            m_stream.write(reinterpret_cast<const char*>(data), size);
+            m_position += size;
+        }
+
+        template<typename T>
+        void Write(const Section& section, const std::vector<T>& items)
+        {
+            static const char padding[8] = { 0 };
+            assert(section.m_offset >= m_position && section.m_offset - m_position < 8);
+            Write(padding, section.m_offset - m_position);
+            if (!items.empty())
+            {
+                Write(items.data(), items.size() * sizeof(T));
+            }
+        }
+    private:
+        std::ostream& m_stream;
+        uint64_t m_position;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(std::istream& stream)
+            : m_stream(stream)
+            , m_position(0)
+        {}
+
+        void Read(void* data, const uint64_t size)
+        {
+            m_stream.read(reinterpret_cast<char*>(data), size);
+            if (!m_stream || (uint64_t)m_stream.gcount() != size)
+            {
+                throw std::runtime_error("Unexpected end of shape stream");
+            }
+            m_position += size;
+        }
+
+        // sections are read in file order; one bulk read per section
+        template<typename T>
+        void Read(const Section& section, std::vector<T>& items)
+        {
+            if (section.m_offset < m_position || section.m_count > NoIndex)
+            {
+                throw std::runtime_error("Malformed shape stream");
+            }
+            m_stream.ignore(section.m_offset - m_position);
+            m_position = section.m_offset;
+            items.resize((size_t)section.m_count);
+            if (!items.empty())
+            {
+                Read(items.data(), items.size() * sizeof(T));
+            }
+        }
+    private:
+        std::istream& m_stream;
+        uint64_t m_position;
+    };
+
+    // Index lookup which accepts NoIndex (null) and rejects out of range indices
+    template<typename T>
+    const T& At(const std::vector<T>& items, const uint32_t index)
+    {
+        static const T null;
+        if (NoIndex == index)
+        {
+            return null;
+        }
+        if (index >= items.size())
+        {
+            throw std::runtime_error("Malformed shape stream");
+        }
+        return items[index];
+    }
+}
+
+Arrays ShapeFormat::Pack(const std::vector<HullRaw>& hulls)
+{
+    Arrays arrays;
+    Indexer<VertexRaw> vertices;
+    Indexer<NormalRaw> normals;
+    Indexer<TextureCoordRaw> textureCoords;
+    Indexer<ColorRaw> colors;
+    Indexer<EdgeRaw> edges;
+
+    arrays.m_hulls.reserve(hulls.size());
+
+    // hulls, faces and edges are numbered in the order they are written
+    for (const HullRaw& hull : hulls)
+    {
+        PackedHull packedHull;
+        packedHull.m_firstFace = (uint32_t)arrays.m_faces.size();
+        packedHull.m_faceCount = (uint32_t)hull->GetFaces().size();
+        packedHull.m_orientation = hull->GetOrientation() == Hull::Orientation::Inward ? 1 : 0;
+        packedHull.m_color = colors(hull->GetColor());
+        packedHull.m_boundingShape = Pack(hull->GetBoundingShape());
+        arrays.m_hulls.emplace_back(packedHull);
+        hull->ForEachFace([&](const FaceRaw& face)
+        {
+            PackedFace packedFace;
+            packedFace.m_firstEdge = (uint32_t)arrays.m_edges.size();
+            packedFace.m_edgeCount = (uint32_t)face->GetEdgeCount();
+            packedFace.m_normal = normals(face->GetNormal());
+            packedFace.m_color = colors(face->GetColor());
+            const uint32_t faceIndex = (uint32_t)arrays.m_faces.size();
+            arrays.m_faces.emplace_back(packedFace);
+            face->ForEachEdge([&](const EdgeRaw& edge)
+            {
+                PackedEdge packedEdge;
+                const uint32_t edgeIndex = edges(edge);
+                assert(edgeIndex == arrays.m_edges.size());
+                packedEdge.m_vertex = vertices(edge->GetStartVertex());
+                packedEdge.m_normal = normals(edge->GetStartNormal());
+                packedEdge.m_textureCoord = textureCoords(edge->GetStartTextureCoord());
+                packedEdge.m_color = colors(edge->GetStartColor());
+                packedEdge.m_face = faceIndex;
+                arrays.m_edges.emplace_back(packedEdge);
+            });
+        });
+    }
+    // edge relations can only be resolved once all edges are numbered
+    const auto& edgeItems = edges.GetItems();
+    for (size_t i = 0; i < edgeItems.size(); ++i)
+    {
+        arrays.m_edges[i].m_twin = edges.Find(edgeItems[i]->GetTwin());
+        arrays.m_edges[i].m_next = edges.Find(edgeItems[i]->GetNext());
+        arrays.m_edges[i].m_prev = edges.Find(edgeItems[i]->GetPrev());
+    }
+
+    arrays.m_vertices = PackVectors<PackedVector3>(vertices.GetItems());
+    arrays.m_normals = PackVectors<PackedVector3>(normals.GetItems());
+    arrays.m_textureCoords = PackVectors<PackedVector2>(textureCoords.GetItems());
+    arrays.m_colors.reserve(colors.GetItems().size());
+    for (const ColorRaw& color : colors.GetItems())
+    {
+        arrays.m_colors.emplace_back(color->GetInt());
+    }
+    return arrays;
+}
+
+View ShapeFormat::GetView(const Arrays& arrays)
+{
+    View view;
+    memset(&view, 0, sizeof(view));
+    FileHeader& header = view.m_header;
+    memcpy(header.m_magic, Magic, sizeof(Magic));
+    header.m_version = Version;
+    header.m_headerSize = sizeof(FileHeader);
+    header.m_vertices.m_count = arrays.m_vertices.size();
+    header.m_normals.m_count = arrays.m_normals.size();
+    header.m_textureCoords.m_count = arrays.m_textureCoords.size();
+    header.m_colors.m_count = arrays.m_colors.size();
+    header.m_edges.m_count = arrays.m_edges.size();
+    header.m_faces.m_count = arrays.m_faces.size();
+    header.m_hulls.m_count = arrays.m_hulls.size();
+    view.m_vertices = arrays.m_vertices.data();
+    view.m_normals = arrays.m_normals.data();
+    view.m_textureCoords = arrays.m_textureCoords.data();
+    view.m_colors = arrays.m_colors.data();
+    view.m_edges = arrays.m_edges.data();
+    view.m_faces = arrays.m_faces.data();
+    view.m_hulls = arrays.m_hulls.data();
+    return view;
+}
+
+void Shape::Save(std::ostream& stream) const
+{
+    GEOMETRY_PROFILE_SCOPE("Shape::Save");
+    GEOMETRY_PROFILE_ELEMENTS(GetHulls().size());
+    Validate().Check("Invalid shape");
+
+    Shape materialized;
+    const Arrays arrays = ShapeFormat::Pack(GetMaterializedHulls(materialized));
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, Magic, sizeof(Magic));
+    header.m_version = Version;
+    header.m_headerSize = sizeof(FileHeader);
+    header.m_boundingShape = ShapeFormat::Pack(GetBoundingShape());
+    uint64_t offset = sizeof(FileHeader);
+    Writer::Layout(header.m_vertices, offset, arrays.m_vertices);
+    Writer::Layout(header.m_normals, offset, arrays.m_normals);
+    Writer::Layout(header.m_textureCoords, offset, arrays.m_textureCoords);
+    Writer::Layout(header.m_colors, offset, arrays.m_colors);
+    Writer::Layout(header.m_edges, offset, arrays.m_edges);
+    Writer::Layout(header.m_faces, offset, arrays.m_faces);
+    Writer::Layout(header.m_hulls, offset, arrays.m_hulls);
+
+    Writer writer(stream);
+    writer.Write(&header, sizeof(header));
+    writer.Write(header.m_vertices, arrays.m_vertices);
+    writer.Write(header.m_normals, arrays.m_normals);
+    writer.Write(header.m_textureCoords, arrays.m_textureCoords);
+    writer.Write(header.m_colors, arrays.m_colors);
+    writer.Write(header.m_edges, arrays.m_edges);
+    writer.Write(header.m_faces, arrays.m_faces);
+    writer.Write(header.m_hulls, arrays.m_hulls);
+}
+
+void Shape::Load(std::istream& stream)
+{
+    GEOMETRY_PROFILE_SCOPE("Shape::Load");
+    Clear();
+
+    Reader reader(stream);
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    reader.Read(&header, offsetof(FileHeader, m_vertices));
+    CheckHeader(header);
+    // newer writers may append fields to the header
+    reader.Read(&header.m_vertices, sizeof(FileHeader) - offsetof(FileHeader, m_vertices));
+
+    Arrays arrays;
+    reader.Read(header.m_vertices, arrays.m_vertices);
+    reader.Read(header.m_normals, arrays.m_normals);
+    reader.Read(header.m_textureCoords, arrays.m_textureCoords);
+    reader.Read(header.m_colors, arrays.m_colors);
+    reader.Read(header.m_edges, arrays.m_edges);
+    reader.Read(header.m_faces, arrays.m_faces);
+    reader.Read(header.m_hulls, arrays.m_hulls);
+
+    Unpack(GetView(arrays), *this);
+    const Hull::ValidationReport report = Validate();
+    if (!report.IsValid())
+    {
+        Clear();
+        report.Check("Malformed shape data");
+    }
+    GEOMETRY_PROFILE_ELEMENTS(GetHulls().size());
+    SetBoundingShape(ShapeFormat::Unpack(header.m_boundingShape));
+}
+
+void ShapeFormat::CheckHeader(const FileHeader& header)
+{
+    if (0 != memcmp(header.m_magic, Magic, sizeof(Magic)) || header.m_version > Version || header.m_headerSize < sizeof(FileHeader))
+    {
+        throw std::runtime_error("Not a (supported) shape stream");
+    }
+}
+
+View ShapeFormat::GetView(const void* data, const uint64_t size)
+{
+    View view;
+    if (size < sizeof(FileHeader))
+    {
+        throw std::runtime_error("Not a (supported) shape stream");
+    }
+    memcpy(&view.m_header, data, sizeof(FileHeader));
+    const FileHeader& header = view.m_header;
+    CheckHeader(header);
+    auto Locate = [data, size](const Section& section, const uint64_t elementSize)
+    {
+        if (section.m_offset % 8 != 0 || section.m_offset > size || section.m_count > NoIndex || section.m_count * elementSize > size - section.m_offset)
+        {
+            throw std::runtime_error("Malformed shape stream");
+        }
+        return reinterpret_cast<const unsigned char*>(data) + section.m_offset;
+    };
+    view.m_vertices = reinterpret_cast<const PackedVector3*>(Locate(header.m_vertices, sizeof(PackedVector3)));
+    view.m_normals = reinterpret_cast<const PackedVector3*>(Locate(header.m_normals, sizeof(PackedVector3)));
+    view.m_textureCoords = reinterpret_cast<const PackedVector2*>(Locate(header.m_textureCoords, sizeof(PackedVector2)));
+    view.m_colors = reinterpret_cast<const uint32_t*>(Locate(header.m_colors, sizeof(uint32_t)));
+    view.m_edges = reinterpret_cast<const PackedEdge*>(Locate(header.m_edges, sizeof(PackedEdge)));
+    view.m_faces = reinterpret_cast<const PackedFace*>(Locate(header.m_faces, sizeof(PackedFace)));
+    view.m_hulls = reinterpret_cast<const PackedHull*>(Locate(header.m_hulls, sizeof(PackedHull)));
+    return view;
+}
+
+std::vector<HullRaw> ShapeFormat::Unpack(const View& view, Shape& shape)
+{
+    const FileHeader& header = view.m_header;
+
+    // shallow structures
+    std::vector<VertexPtr> vertices;
+    vertices.reserve((size_t)header.m_vertices.m_count);
+    for (uint64_t i = 0; i < header.m_vertices.m_count; ++i)
+    {
+        const auto& v = view.m_vertices[i];
+        vertices.emplace_back(Construct<Vertex>(v.m_data[0], v.m_data[1], v.m_data[2]));
+    }
+    std::vector<NormalPtr> normals;
+    normals.reserve((size_t)header.m_normals.m_count);
+    for (uint64_t i = 0; i < header.m_normals.m_count; ++i)
+    {
+        const auto& n = view.m_normals[i];
+        normals.emplace_back(Construct<Normal>(n.m_data[0], n.m_data[1], n.m_data[2]));
+    }
+    std::vector<TextureCoordPtr> textureCoords;
+    textureCoords.reserve((size_t)header.m_textureCoords.m_count);
+    for (uint64_t i = 0; i < header.m_textureCoords.m_count; ++i)
+    {
+        const auto& t = view.m_textureCoords[i];
+        textureCoords.emplace_back(Construct<TextureCoord>(t.m_data[0], t.m_data[1]));
+    }
+    std::vector<ColorPtr> colors;
+    colors.reserve((size_t)header.m_colors.m_count);
+    for (uint64_t i = 0; i < header.m_colors.m_count; ++i)
+    {
+        colors.emplace_back(Construct<Color>((unsigned int)view.m_colors[i]));
+    }
+
+    // hulls and faces
+    std::vector<HullRaw> hulls;
+    hulls.reserve((size_t)header.m_hulls.m_count);
+    std::vector<FacePtr> faces((size_t)header.m_faces.m_count);
+    for (uint64_t h = 0; h < header.m_hulls.m_count; ++h)
+    {
+        const auto& packedHull = view.m_hulls[h];
+        if ((uint64_t)packedHull.m_firstFace + packedHull.m_faceCount > faces.size())
+        {
+            throw std::runtime_error("Malformed shape stream");
+        }
+        auto hull = shape.ConstructAndAddHull();
+        hulls.emplace_back(hull);
+        hull->SetOrientation(packedHull.m_orientation == 1 ? Hull::Orientation::Inward : Hull::Orientation::Outward);
+        hull->SetColor(At(colors, packedHull.m_color));
+        hull->SetBoundingShape(Unpack(packedHull.m_boundingShape));
+        for (uint32_t i = packedHull.m_firstFace; i < packedHull.m_firstFace + packedHull.m_faceCount; ++i)
+        {
+            const auto& packedFace = view.m_faces[i];
+            auto face = hull->ConstructAndAddFace();
+            face->SetNormal(At(normals, packedFace.m_normal));
+            face->SetColor(At(colors, packedFace.m_color));
+            faces[i] = face;
+        }
+    }
+
+    // edges; first create them, then link them
+    std::vector<EdgePtr> edges;
+    edges.reserve((size_t)header.m_edges.m_count);
+    for (uint64_t i = 0; i < header.m_edges.m_count; ++i)
+    {
+        const auto& packedEdge = view.m_edges[i];
+        const auto& face = At(faces, packedEdge.m_face);
+        if (!face)
+        {
+            throw std::runtime_error("Malformed shape stream");
+        }
+        auto edge = face->ConstructAndAddEdge(At(vertices, packedEdge.m_vertex), At(normals, packedEdge.m_normal));
+        edge->SetStartTextureCoord(At(textureCoords, packedEdge.m_textureCoord));
+        edge->SetStartColor(At(colors, packedEdge.m_color));
+        edges.emplace_back(edge);
+    }
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const auto& packedEdge = view.m_edges[i];
+        edges[i]->SetTwin(At(edges, packedEdge.m_twin));
+        edges[i]->SetNext(At(edges, packedEdge.m_next));
+        edges[i]->SetPrev(At(edges, packedEdge.m_prev));
+    }
+    return hulls;
+}
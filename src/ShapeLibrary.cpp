@@ -0,0 +1,211 @@
+#include "Geometry.h"
+#include "ShapeStorage.h"
+using namespace std;
+using namespace Geometry;
+using namespace Geometry::ShapeStorage;
+
+namespace
+{
+    const int64_t LibraryVersion = 1;
+}
+
+class ShapeLibrary::State
+{
+public:
+    // all access to the db goes through this lock, hulls are loaded from any thread
+    std::mutex m_mutex;
+    SQLite::DB m_db;
+};
+
+ShapeLibrary::ShapeLibrary()
+    : m_state()
+{
+}
+
+ShapeLibrary::~ShapeLibrary()
+{
+    Close();
+}
+
+void ShapeLibrary::Open(const std::string& fileName, bool readOnly)
+{
+    Close();
+    std::shared_ptr<State> state = std::make_shared<State>();
+    SQLite::DB& db = state->m_db;
+    db.Open(fileName, readOnly);
+    if (!readOnly && !db.TableExists("Header"))
+    {
+        db.BeginTransaction();
+        db.ExecDML("CREATE TABLE Header(Key TEXT PRIMARY KEY,Value) WITHOUT ROWID");
+        db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Type','ShapeLibrary')");
+        db.ExecDMLParams("INSERT INTO Header(Key,Value) VALUES('Version',?1)", LibraryVersion);
+        db.ExecDML("CREATE TABLE Shapes(Id INTEGER PRIMARY KEY,Name TEXT,BoundingShape INTEGER)");
+        CreateHullsTable(db);
+        db.ExecDML("CREATE INDEX HullsShape ON Hulls(Shape)");
+        CreateBoundingShapesTable(db);
+        db.CommitTransaction();
+    }
+    if (!db.TableExists("Header")
+        || db.ExecSingleString("SELECT Value FROM Header WHERE Key='Type'") != "ShapeLibrary"
+        || db.ExecSingleInt64("SELECT Value FROM Header WHERE Key='Version'") != LibraryVersion)
+    {
+        throw std::runtime_error("Not a (supported) shape library");
+    }
+    m_state.swap(state);
+}
+
+void ShapeLibrary::Close()
+{
+    // shapes with hulls which aren't loaded yet keep the state alive
+    m_state.reset();
+}
+
+bool ShapeLibrary::IsOpen() const
+{
+    return nullptr != m_state;
+}
+
+ShapeLibrary::State& ShapeLibrary::GetState() const
+{
+    if (!m_state)
+    {
+        throw std::runtime_error("Shape library is not open");
+    }
+    return *m_state;
+}
+
+std::vector<ShapeLibrary::Entry> ShapeLibrary::GetShapes() const
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+    std::vector<Entry> entries;
+    SQLite::Query query = state.m_db.ExecQuery("SELECT Id,Name FROM Shapes ORDER BY Id");
+    for (; !query.IsEOF(); query.NextRow())
+    {
+        entries.push_back({ query.GetInt64Field(0), query.GetStringField(1) });
+    }
+    return entries;
+}
+
+int64_t ShapeLibrary::Add(const std::string& name, const Shape& shape)
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+    SQLite::DB& db = state.m_db;
+
+    Shape materialized;
+    const std::vector<HullRaw> hulls = shape.GetMaterializedHulls(materialized);
+
+    db.BeginTransaction();
+    try
+    {
+        const BoundingShapeStorer StoreBoundingShape = CreateBoundingShapeStorer(db, db.ExecSingleInt64("SELECT MAX(Id) FROM BoundingShapes") + 1);
+        db.ExecDMLParams("INSERT INTO Shapes(Name,BoundingShape) VALUES(?1,?2)", name, StoreBoundingShape(shape.GetBoundingShape()));
+        const int64_t id = db.LastRowId();
+
+        int64_t hullId = db.ExecSingleInt64("SELECT IFNULL(MAX(Id),0) FROM Hulls");
+        SQLite::Statement s = db.CompileStatement(HullsInsert);
+        for (const HullRaw& hull : hulls)
+        {
+            // proxies are culled on their bounding shape, so every hull gets one; an approximate one will do
+            BoundingShape3d boundingShape = hull->GetBoundingShape();
+            if (boundingShape.GetType() == BoundingShape3d::Type::Unknown)
+            {
+                const auto& vertices = hull->GetVertices();
+                boundingShape.Set(BoundingShape3d::Type::Ball, vertices.begin(), vertices.end(), BoundingShape3d::Accuracy::Approximate);
+            }
+            InsertHull(s, ++hullId, id, hull, boundingShape, StoreBoundingShape);
+        }
+        db.CommitTransaction();
+        return id;
+    }
+    catch (...)
+    {
+        db.RollbackTransaction();
+        throw;
+    }
+}
+
+void ShapeLibrary::Remove(const int64_t id)
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+    SQLite::DB& db = state.m_db;
+    db.BeginTransaction();
+    try
+    {
+        db.ExecDMLParams("DELETE FROM BoundingShapes WHERE Id<>0 AND Id IN (SELECT BoundingShape FROM Hulls WHERE Shape=?1 UNION SELECT BoundingShape FROM Shapes WHERE Id=?1)", id);
+        db.ExecDMLParams("DELETE FROM Hulls WHERE Shape=?1", id);
+        db.ExecDMLParams("DELETE FROM Shapes WHERE Id=?1", id);
+        db.CommitTransaction();
+    }
+    catch (...)
+    {
+        db.RollbackTransaction();
+        throw;
+    }
+}
+
+ShapePtr ShapeLibrary::Retrieve(const int64_t id, const bool lazy) const
+{
+    GetState();
+    std::shared_ptr<State> state = m_state;
+    ShapePtr shape = Construct<Shape>();
+    {
+        std::lock_guard<std::mutex> lock(state->m_mutex);
+        SQLite::DB& db = state->m_db;
+        db.BeginTransaction();
+        try
+        {
+            const std::string boundingShapeColumns = BoundingShapeColumns(db, "b.");
+            SQLite::Query query = db.ExecQueryParams("SELECT " + boundingShapeColumns + " FROM Shapes s LEFT JOIN BoundingShapes b ON b.Id=s.BoundingShape WHERE s.Id=?1", id);
+            if (query.IsEOF())
+            {
+                throw std::runtime_error("Unknown shape in library");
+            }
+            shape->SetBoundingShape(ShapeStorage::GetBoundingShape(query, 0));
+            query.Finalize();
+
+            // the hulls, with everything but their geometry
+            query = db.ExecQueryParams("SELECT h.Id,h.Orientation,h.Color," + boundingShapeColumns + " FROM Hulls h LEFT JOIN BoundingShapes b ON b.Id=h.BoundingShape WHERE h.Shape=?1 ORDER BY h.Id", id);
+            for (; !query.IsEOF(); query.NextRow())
+            {
+                const int64_t hullId = query.GetInt64Field(0);
+                const BoundingShape3d boundingShape = ShapeStorage::GetBoundingShape(query, 3);
+                const HullPtr& hull = shape->ConstructAndAddHull();
+                hull->SetOrientation(Orientation::Convert(query.GetInt64Field(1)));
+                const int64_t color = query.GetInt64Field(2);
+                if (color != -1)
+                {
+                    hull->SetColor(Construct<Color>((unsigned int)color));
+                }
+                hull->SetBoundingShape(boundingShape);
+                hull->SetLoader([state, hullId, boundingShape](Shape& loaded)
+                {
+                    std::lock_guard<std::mutex> lock(state->m_mutex);
+                    SQLite::Query query = state->m_db.ExecQueryParams(std::string("SELECT ") + HullsColumns + " FROM Hulls WHERE Id=?1", hullId);
+                    if (query.IsEOF())
+                    {
+                        throw std::runtime_error("Hull removed from shape library");
+                    }
+                    const ShapeFormat::Arrays arrays = GetHullArrays(query, boundingShape);
+                    query.Finalize();
+                    ShapeFormat::Unpack(ShapeFormat::GetView(arrays), loaded);
+                    loaded.Validate().Check("Malformed shape data");
+                });
+            }
+            query.Finalize();
+            db.CommitTransaction();
+        }
+        catch (...)
+        {
+            db.RollbackTransaction();
+            throw;
+        }
+    }
+    if (!lazy)
+    {
+        shape->ForEachHull([](const HullRaw& hull) { hull->Load(); });
+    }
+    return shape;
+}
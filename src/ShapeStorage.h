@@ -0,0 +1,84 @@
+#pragma once
+
+// Helpers shared by Shape::Store/Retrieve and ShapeLibrary; implemented in Shape.cpp
+namespace Geometry
+{
+    namespace ShapeStorage
+    {
+        struct Orientation
+        {
+            static int64_t Convert(Hull::Orientation orientation)
+            {
+                switch (orientation)
+                {
+                case Hull::Orientation::Inward: return 0;
+                case Hull::Orientation::Outward: return 1;
+                default:
+                    assert(false); // wickedly wrong orientation value!
+                    return -1;
+                }
+            }
+            static Hull::Orientation Convert(int64_t orientation)
+            {
+                switch (orientation)
+                {
+                case 0: return Hull::Orientation::Inward;
+                default:
+                    assert(false); // wickedly wrong orientation value!
+                case 1: return Hull::Orientation::Outward;
+                }
+            }
+        };
+        struct BoundingShapeType
+        {
+            static int64_t Convert(BoundingShape3d::Type type)
+            {
+                switch (type)
+                {
+                default:
+                    assert(false); // wickedly wrong type value!
+                case BoundingShape3d::Type::Unknown: return 0;
+                case BoundingShape3d::Type::Ball: return 1;
+                case BoundingShape3d::Type::Box: return 2;
+                case BoundingShape3d::Type::OrientedBox: return 3;
+                }
+            }
+            static BoundingShape3d::Type Convert(int64_t type)
+            {
+                switch (type)
+                {
+                default:
+                    assert(false); // wickedly wrong orientation value!
+                case 0: return BoundingShape3d::Type::Unknown;
+                case 1: return BoundingShape3d::Type::Ball;
+                case 2: return BoundingShape3d::Type::Box;
+                case 3: return BoundingShape3d::Type::OrientedBox;
+                }
+            }
+        };
+
+        // Stores a bounding shape and returns its id (0 for an unknown bounding shape)
+        typedef std::function<int64_t(const BoundingShape3d& bs)> BoundingShapeStorer;
+
+        // BoundingShapes table, with the row for the unknown bounding shape (Id 0). A ball uses x0..z0 and Radius,
+        // a box x0..z0 (min) and x1..z1 (max), an oriented box x0..z0 (center), x1..z1 (half extents) and the
+        // rotation from the coordinate axes to its axes qw..qz.
+        void CreateBoundingShapesTable(SQLite::DB& db);
+        // Storer which inserts bounding shapes with ids firstId, firstId+1, ...; adds the qw..qz columns to a table
+        // which was created before oriented boxes existed
+        BoundingShapeStorer CreateBoundingShapeStorer(SQLite::DB& db, const int64_t firstId);
+        // The columns read by GetBoundingShape, each prefixed with prefix; NULL for missing qw..qz columns
+        std::string BoundingShapeColumns(SQLite::DB& db, const std::string& prefix);
+        // Read the bounding shape from the BoundingShapeColumns starting at firstField
+        BoundingShape3d GetBoundingShape(const SQLite::Query& query, const int firstField);
+
+        // Hulls table of the blob layout; every hull row refers to its shape
+        void CreateHullsTable(SQLite::DB& db);
+        // Insert a hull into the Hulls table, using a statement compiled from HullsInsert
+        extern const char* HullsInsert;
+        void InsertHull(SQLite::Statement& s, const int64_t id, const int64_t shapeId, const HullRaw& hull, const BoundingShape3d& boundingShape, const BoundingShapeStorer& StoreBoundingShape);
+        // Build the arrays of one hull from a row with the HullsColumns
+        extern const char* HullsColumns;
+        ShapeFormat::Arrays GetHullArrays(const SQLite::Query& query, const BoundingShape3d& boundingShape);
+    }
+}
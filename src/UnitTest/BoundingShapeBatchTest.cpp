@@ -0,0 +1,121 @@
+#include "CommonTestFunctionality.h"
+
+class BoundingShapeBatchTest : public Test
+{
+protected:
+    virtual void SetUp()
+    {
+        // balls, boxes, oriented boxes and a few uninitialized bounding shapes on a 10x10x10 area
+        std::mt19937 generator(3);
+        std::uniform_real_distribution<double> position(-5, 5);
+        std::uniform_real_distribution<double> size(0.1, 1);
+        for (int i = 0; i < 300; ++i)
+        {
+            const Vector3d center(position(generator), position(generator), position(generator));
+            const Vector3d halfSize(size(generator), size(generator), size(generator));
+            switch (i % 7)
+            {
+            case 0:
+            case 1:
+            case 2:
+                m_shapes.emplace_back(center, halfSize[0]);
+                break;
+            case 3:
+            case 4:
+                m_shapes.emplace_back(center - halfSize, center + halfSize);
+                break;
+            case 5:
+                {
+                    const Quat rotation(Vector3d(position(generator), position(generator), 1).Normalized(), position(generator));
+                    BoundingShape3d::axes_type axes = { rotation.Transform(Vector3d(1, 0, 0)), rotation.Transform(Vector3d(0, 1, 0)), rotation.Transform(Vector3d(0, 0, 1)) };
+                    m_shapes.emplace_back(center, axes, halfSize);
+                }
+                break;
+            case 6:
+                m_shapes.emplace_back();
+                break;
+            }
+            m_batch.Add(m_shapes.back());
+        }
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    std::vector<BoundingShapeBatch::index_type> Expected(const BoundingShape3d& query) const
+    {
+        std::vector<BoundingShapeBatch::index_type> indices;
+        for (size_t i = 0; i < m_shapes.size(); ++i)
+        {
+            if (m_shapes[i].IsInitialized() && query.Touches(m_shapes[i]))
+            {
+                indices.push_back((BoundingShapeBatch::index_type)i);
+            }
+        }
+        return indices;
+    }
+
+    std::vector<BoundingShape3d> m_shapes;
+    BoundingShapeBatch m_batch;
+};
+
+TEST_F(BoundingShapeBatchTest, Touches)
+{
+    EXPECT_EQ(m_shapes.size(), m_batch.GetSize());
+    const BoundingShape3d::axes_type axes = { Vector3d(1, 1, 0).Normalized(), Vector3d(-1, 1, 0).Normalized(), Vector3d(0, 0, 1) };
+    std::vector<BoundingShape3d> queries = {
+        BoundingShape3d(Vector3d(0, 0, 0), 2.0),
+        BoundingShape3d(Vector3d(3, -2, 1), 0.5),
+        BoundingShape3d(Vector3d(-4, -4, -4), Vector3d(-1, 0, 4)),
+        BoundingShape3d(Vector3d(1, 1, 1), axes, Vector3d(3, 0.5, 2)) };
+    for (const BoundingShape3d& query : queries)
+    {
+        std::vector<BoundingShapeBatch::index_type> indices;
+        m_batch.Touches(query, indices);
+        EXPECT_FALSE(indices.empty());
+        EXPECT_EQ(Expected(query), indices);
+    }
+
+    std::vector<uint64_t> mask;
+    m_batch.Touches(BoundingShape3d(), mask);
+    EXPECT_EQ(5u, mask.size());
+    EXPECT_TRUE(std::all_of(mask.begin(), mask.end(), [](const uint64_t word) { return word == 0; }));
+}
+
+TEST_F(BoundingShapeBatchTest, Encapsulates)
+{
+    std::vector<BoundingShapeBatch::index_type> indices;
+    for (size_t i = 0; i < m_shapes.size(); ++i)
+    {
+        if (m_shapes[i].GetType() == BoundingShape3d::Type::Ball || m_shapes[i].GetType() == BoundingShape3d::Type::OrientedBox)
+        {
+            m_batch.Encapsulates(m_shapes[i].GetCenter(), indices);
+            EXPECT_TRUE(std::binary_search(indices.begin(), indices.end(), (BoundingShapeBatch::index_type)i));
+            for (const BoundingShapeBatch::index_type index : indices)
+            {
+                EXPECT_TRUE(m_shapes[index].Encapsulates(m_shapes[i].GetCenter()));
+            }
+        }
+    }
+}
+
+TEST_F(BoundingShapeBatchTest, Set)
+{
+    const BoundingShape3d query(Vector3d(20, 20, 20), 1.0);
+    std::vector<BoundingShapeBatch::index_type> indices;
+    m_batch.Touches(query, indices);
+    EXPECT_TRUE(indices.empty());
+
+    const BoundingShape3d::axes_type axes = { Vector3d(1, 0, 0), Vector3d(0, 1, 0), Vector3d(0, 0, 1) };
+    m_batch.Set(5, BoundingShape3d(Vector3d(21, 20, 20), axes, Vector3d(1, 1, 1)));
+    m_batch.Set(7, BoundingShape3d(Vector3d(18, 18, 18), Vector3d(19.5, 19.5, 19.2)));
+    m_batch.Touches(query, indices);
+    EXPECT_EQ(std::vector<BoundingShapeBatch::index_type>({ 5 }), indices);
+    EXPECT_THROW(m_batch.Set(300, query), std::runtime_error);
+
+    m_batch.Clear();
+    EXPECT_EQ(0u, m_batch.GetSize());
+    m_batch.Touches(query, indices);
+    EXPECT_TRUE(indices.empty());
+}
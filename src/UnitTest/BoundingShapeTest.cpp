@@ -53,6 +53,67 @@ TEST_F(BoundingShapeTest, Volume)
     EXPECT_NEAR(4 * Numerics::Constants::Pi*pow(sqrt(3), 3) / 3, ball3.CalculateVolume(), 0.01);
 }
 
+TEST_F(BoundingShapeTest, Transform)
+{
+    BoundingShape3d ball(Vector3d(1, 0, 0), 1);
+    ball.Scale(-2);
+    ball.Translate(Vector3d(0, 1, 0));
+    ball.Rotate(Quat(Vector3d(0, 0, 1), Numerics::Constants::Pi / 2));
+    EXPECT_NEAR(0, Distance(Vector3d(-1, -2, 0), ball.GetCenter()), 1e-12);
+    EXPECT_DOUBLE_EQ(2, ball.GetRadius());
+    EXPECT_TRUE(ball.IsOptimal());
+
+    BoundingShape3d box(Vector3d(0, 0, 0), Vector3d(2, 1, 1));
+    box.Scale(-1);
+    EXPECT_EQ(Vector3d(-2, -1, -1), box.GetMin());
+    box.Translate(Vector3d(2, 1, 1));
+    EXPECT_EQ(Vector3d(2, 1, 1), box.GetMax());
+    EXPECT_TRUE(box.IsOptimal());
+    // the box around the box rotated by 45 degrees
+    box.Rotate(Quat(Vector3d(0, 0, 1), Numerics::Constants::Pi / 4));
+    EXPECT_FALSE(box.IsOptimal());
+    EXPECT_NEAR(-sqrt(0.5), box.GetMin()[0], 1e-12);
+    EXPECT_NEAR(2 * sqrt(0.5), box.GetMax()[0], 1e-12);
+    EXPECT_NEAR(3 * sqrt(0.5), box.GetMax()[1], 1e-12);
+    EXPECT_NEAR(1, box.GetMax()[2], 1e-12);
+
+    BoundingShape3d::axes_type axes = { Vector3d(1, 0, 0), Vector3d(0, 1, 0), Vector3d(0, 0, 1) };
+    BoundingShape3d obb(Vector3d(1, 0, 0), axes, Vector3d(2, 1, 1));
+    obb.Rotate(Quat(Vector3d(0, 0, 1), Numerics::Constants::Pi / 2));
+    EXPECT_NEAR(0, Distance(Vector3d(0, 1, 0), obb.GetCenter()), 1e-12);
+    EXPECT_NEAR(0, Distance(Vector3d(0, 1, 0), obb.GetAxes()[0]), 1e-12);
+    EXPECT_DOUBLE_EQ(16, obb.CalculateVolume());
+
+    BoundingShape3d unknown;
+    unknown.Scale(2);
+    EXPECT_FALSE(unknown.IsInitialized());
+}
+
+TEST_F(BoundingShapeTest, Enclose)
+{
+    BoundingShape3d box;
+    box.Enclose(BoundingShape3d(Vector3d(0, 0, 0), Vector3d(1, 1, 1)));
+    box.Enclose(BoundingShape3d(Vector3d(2, -1, 0), Vector3d(3, 0, 1)));
+    box.Enclose(BoundingShape3d());
+    EXPECT_EQ(Vector3d(0, -1, 0), box.GetMin());
+    EXPECT_EQ(Vector3d(3, 1, 1), box.GetMax());
+    EXPECT_TRUE(box.IsOptimal());
+    box.Enclose(BoundingShape3d(Vector3d(0, 0, 4), 1));
+    EXPECT_EQ(Vector3d(3, 1, 5), box.GetMax());
+    EXPECT_FALSE(box.IsOptimal());
+
+    BoundingShape3d ball(Vector3d(0, 0, 0), 1);
+    ball.Enclose(BoundingShape3d(Vector3d(0.5, 0, 0), 0.5));
+    EXPECT_DOUBLE_EQ(1, ball.GetRadius());
+    EXPECT_TRUE(ball.IsOptimal());
+    ball.Enclose(BoundingShape3d(Vector3d(4, 0, 0), 2));
+    EXPECT_NEAR(3.5, ball.GetRadius(), 1e-12);
+    EXPECT_NEAR(2.5, ball.GetCenter()[0], 1e-12);
+    EXPECT_FALSE(ball.IsOptimal());
+    EXPECT_TRUE(ball.Encapsulates(Vector3d(-1, 0, 0)));
+    EXPECT_TRUE(ball.Encapsulates(Vector3d(6, 0, 0)));
+}
+
 TEST_F(BoundingShapeTest, BallTouchesBox)
 {
     //  0 | 1 | 2
@@ -113,3 +174,124 @@ TEST_F(BoundingShapeTest, BallTouchesBox)
     EXPECT_FALSE(box.Touches(ball80));
     EXPECT_TRUE(box.Touches(ball81));
 }
+
+TEST_F(BoundingShapeTest, ApproximateBall)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<VertexPtr> vertices;
+    for (int i = 0; i < 10000; ++i)
+    {
+        vertices.emplace_back(Construct<Vertex>(3 * distribution(generator) + 1, distribution(generator), 2 * distribution(generator) - 5));
+    }
+    BoundingShape3d exact, approximate;
+    exact.Set(BoundingShape3d::Type::Ball, vertices.begin(), vertices.end());
+    approximate.Set(BoundingShape3d::Type::Ball, vertices.begin(), vertices.end(), BoundingShape3d::Accuracy::Approximate);
+    EXPECT_TRUE(exact.IsOptimal());
+    EXPECT_EQ(BoundingShape3d::Type::Ball, approximate.GetType());
+    EXPECT_FALSE(approximate.IsOptimal());
+    for (const VertexPtr& vertex : vertices)
+    {
+        EXPECT_TRUE(approximate.Encapsulates(*vertex));
+    }
+    EXPECT_GE(approximate.GetRadius(), exact.GetRadius());
+    const double tightness = BoundingShape3d::BallTightness(vertices.begin(), vertices.end());
+    EXPECT_DOUBLE_EQ(approximate.GetRadius() / exact.GetRadius(), tightness);
+    EXPECT_LT(tightness, 1.1);
+
+    // points on a sphere
+    ShapePtr dodecahedron = Construct<Dodecahedron>();
+    dodecahedron->SplitTrianglesIn4();
+    dodecahedron->ForEachHull([](const HullRaw& hull)
+    {
+        hull->CalculateBoundingShape(BoundingShape3d::Type::Ball, BoundingShape3d::Accuracy::Approximate);
+        const BoundingShape3d& ball = hull->GetBoundingShape();
+        EXPECT_NEAR(1, ball.GetRadius(), 0.05);
+        hull->ForEachFace([&ball](const FaceRaw& face) { face->ForEachVertex([&ball](const VertexRaw& vertex) { EXPECT_TRUE(ball.Encapsulates(*vertex)); }); });
+    });
+
+    std::vector<VertexPtr> none;
+    approximate.Set(BoundingShape3d::Type::Ball, none.begin(), none.end(), BoundingShape3d::Accuracy::Approximate);
+    EXPECT_FALSE(approximate.IsInitialized());
+}
+
+TEST_F(BoundingShapeTest, OrientedBox)
+{
+    // elongated box of points, rotated away from the coordinate axes
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    const Quat rotation(Vector3d(1, 2, 3).Normalized(), 0.7);
+    std::vector<VertexPtr> vertices;
+    for (int i = 0; i < 10000; ++i)
+    {
+        const Vector3d v(10 * distribution(generator), 2 * distribution(generator), distribution(generator));
+        vertices.emplace_back(Construct<Vertex>(rotation.Transform(v) + Vector3d(5, -3, 1)));
+    }
+    BoundingShape3d box, obb;
+    box.Set(BoundingShape3d::Type::Box, vertices.begin(), vertices.end());
+    obb.Set(BoundingShape3d::Type::OrientedBox, vertices.begin(), vertices.end());
+    EXPECT_EQ(BoundingShape3d::Type::OrientedBox, obb.GetType());
+    EXPECT_FALSE(obb.IsOptimal());
+    for (const VertexPtr& vertex : vertices)
+    {
+        EXPECT_TRUE(obb.Encapsulates(*vertex));
+    }
+    EXPECT_LT(obb.CalculateVolume(), box.CalculateVolume() / 2);
+    EXPECT_NEAR(8 * 10 * 2 * 1, obb.CalculateVolume(), 8);
+    EXPECT_NEAR(1, std::abs(obb.GetAxes()[0].InnerProduct(rotation.Transform(Vector3d(1, 0, 0)))), 1e-3);
+
+    // axis aligned points keep the axis aligned box
+    BoundingShape3d aligned;
+    aligned.Set(BoundingShape3d::Type::OrientedBox, vertices.begin(), vertices.begin() + 1);
+    EXPECT_EQ(BoundingShape3d::Type::OrientedBox, aligned.GetType());
+    EXPECT_DOUBLE_EQ(0, aligned.CalculateVolume());
+
+    std::vector<VertexPtr> none;
+    obb.Set(BoundingShape3d::Type::OrientedBox, none.begin(), none.end());
+    EXPECT_FALSE(obb.IsInitialized());
+}
+
+TEST_F(BoundingShapeTest, OrientedBoxTouches)
+{
+    // unit cube rotated 45 degrees around z: its corners reach sqrt(2) along x and y
+    BoundingShape3d::axes_type axes = { Vector3d(1, 1, 0).Normalized(), Vector3d(-1, 1, 0).Normalized(), Vector3d(0, 0, 1) };
+    const BoundingShape3d obb(Vector3d(0, 0, 0), axes, Vector3d(1, 1, 1));
+
+    EXPECT_TRUE(obb.Touches(BoundingShape3d(Vector3d(1.3, -0.5, -0.5), Vector3d(2, 0.5, 0.5))));
+    EXPECT_FALSE(obb.Touches(BoundingShape3d(Vector3d(1.3, 0.9, -0.5), Vector3d(2, 2, 0.5))));
+    EXPECT_TRUE(BoundingShape3d(Vector3d(1.3, -0.5, -0.5), Vector3d(2, 0.5, 0.5)).Touches(obb));
+
+    EXPECT_TRUE(obb.Touches(BoundingShape3d(Vector3d(1.8, 0, 0), 0.5)));
+    EXPECT_FALSE(obb.Touches(BoundingShape3d(Vector3d(1.5, 1.5, 0), 0.5)));
+    EXPECT_TRUE(BoundingShape3d(Vector3d(1.5, 1.5, 0), 1.2).Touches(obb));
+
+    // cube rotated around y, its edge along y faces the edge along z of obb; only x (the cross product of the
+    // edges) separates them
+    BoundingShape3d::axes_type axes1 = { Vector3d(1, 0, 1).Normalized(), Vector3d(0, 1, 0), Vector3d(-1, 0, 1).Normalized() };
+    EXPECT_FALSE(obb.Touches(BoundingShape3d(Vector3d(2 * sqrt(2) + 0.01, 0, 0), axes1, Vector3d(1, 1, 1))));
+    EXPECT_TRUE(obb.Touches(BoundingShape3d(Vector3d(2 * sqrt(2) - 0.01, 0, 0), axes1, Vector3d(1, 1, 1))));
+    EXPECT_TRUE(obb.Touches(obb));
+}
+
+TEST_F(BoundingShapeTest, OrientedBoxConvert)
+{
+    BoundingShape3d::axes_type axes = { Vector3d(1, 1, 0).Normalized(), Vector3d(-1, 1, 0).Normalized(), Vector3d(0, 0, 1) };
+    const BoundingShape3d obb(Vector3d(1, 2, 3), axes, Vector3d(1, 1, 2));
+    EXPECT_DOUBLE_EQ(16, obb.CalculateVolume());
+
+    BoundingShape3d box = obb;
+    box.Convert(BoundingShape3d::Type::Box);
+    EXPECT_NEAR(1 - sqrt(2), box.GetMin()[0], 1e-12);
+    EXPECT_NEAR(2 + sqrt(2), box.GetMax()[1], 1e-12);
+    EXPECT_NEAR(5, box.GetMax()[2], 1e-12);
+    EXPECT_FALSE(box.IsOptimal());
+
+    BoundingShape3d ball = obb;
+    ball.Convert(BoundingShape3d::Type::Ball);
+    EXPECT_NEAR(sqrt(6), ball.GetRadius(), 1e-12);
+
+    box.Convert(BoundingShape3d::Type::OrientedBox);
+    EXPECT_EQ(BoundingShape3d::Type::OrientedBox, box.GetType());
+    EXPECT_NEAR(8 * 2 * 2, box.CalculateVolume(), 1e-9);
+    EXPECT_TRUE(box.Encapsulates(Vector3d(1, 2, 3) + axes[0] + axes[1]));
+}
@@ -40,7 +40,7 @@ TEST_F(FaceTest, CalcNormal)
     e1->SetTwin(e1);
     e2->SetTwin(e2);
     face->CalcNormal();
-    EXPECT_EQ(Vector3d(0,0,1),*face->GetNormal());
+    EXPECT_EQ(Normal(0,0,1),*face->GetNormal());
 }
 
 TEST_F(FaceTest, SplitSquare) 
@@ -0,0 +1,135 @@
+#include "CommonTestFunctionality.h"
+#include <cstdio>
+#include <fstream>
+
+class MappedShapeTest : public Test 
+{
+protected:
+    virtual void SetUp() 
+    {
+        m_shape = Construct<Dodecahedron>();
+        m_shape->SplitTrianglesIn4();
+        m_shape->SetBoundingShape(BoundingShape3d(Vector3d(0, 0, 0), 2.0));
+        m_shape->ForEachHull([](const HullRaw& hull) { hull->CalculateBoundingShape(BoundingShape3d::Type::Box); });
+        std::ofstream stream(m_fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        m_shape->Save(stream);
+    }
+
+    virtual void TearDown() 
+    {
+        std::remove(m_fileName);
+    }
+
+    const char* m_fileName = "MappedShapeTest.shape";
+    ShapePtr m_shape;
+};
+
+TEST_F(MappedShapeTest, Counts)
+{
+    MappedShape mapped(m_fileName);
+    ASSERT_TRUE(mapped.IsOpen());
+    size_t faces = 0, edges = 0;
+    std::set<VertexRaw> vertices;
+    m_shape->ForEachFace([&faces](const FaceRaw& face) { ++faces; });
+    m_shape->ForEachEdge([&edges](const EdgeRaw& edge) { ++edges; });
+    m_shape->ForEachVertex([&vertices](const VertexRaw& vertex) { vertices.emplace(vertex); });
+    EXPECT_EQ(m_shape->GetHulls().size(), mapped.GetHullCount());
+    EXPECT_EQ(faces, mapped.GetFaceCount());
+    EXPECT_EQ(edges, mapped.GetEdgeCount());
+    EXPECT_EQ(vertices.size(), mapped.GetVertexCount());
+    size_t hullVertices = 0;
+    mapped.GetHull(0).ForEachVertex([&hullVertices](const VertexRaw& vertex) { ++hullVertices; });
+    EXPECT_EQ(vertices.size(), hullVertices);
+}
+
+TEST_F(MappedShapeTest, BoundingShapes)
+{
+    MappedShape mapped(m_fileName);
+    EXPECT_EQ(m_shape->GetBoundingShape(), mapped.GetBoundingShape());
+    EXPECT_EQ((*m_shape->GetHulls().begin())->GetBoundingShape(), mapped.GetHull(0).GetBoundingShape());
+}
+
+TEST_F(MappedShapeTest, Topology)
+{
+    MappedShape mapped(m_fileName);
+    mapped.ForEachEdge([](const MappedShape::EdgeView& edge)
+    {
+        EXPECT_EQ(edge, edge.GetTwin().GetTwin());
+        EXPECT_EQ(edge, edge.GetNext().GetPrev());
+        EXPECT_EQ(edge.GetNext().GetStartVertex(), edge.GetTwin().GetStartVertex());
+    });
+    mapped.ForEachFace([](const MappedShape::FaceView& face)
+    {
+        EXPECT_EQ(3, face.GetEdgeCount());
+        EXPECT_TRUE(face.GetNormal() != nullptr);
+    });
+}
+
+TEST_F(MappedShapeTest, Materialize)
+{
+    MappedShape mapped(m_fileName);
+    ShapePtr shape = mapped.Materialize();
+    EXPECT_NEAR(m_shape->CalculateVolume(), shape->CalculateVolume(), 1e-9);
+    mapped.Close();
+    EXPECT_FALSE(mapped.IsOpen());
+    EXPECT_NEAR(m_shape->CalculateVolume(), shape->CalculateVolume(), 1e-9);
+}
+
+TEST_F(MappedShapeTest, Invalid)
+{
+    {
+        std::ofstream stream(m_fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        stream << "not a shape";
+    }
+    MappedShape mapped;
+    EXPECT_THROW(mapped.Open(m_fileName), std::runtime_error);
+    EXPECT_FALSE(mapped.IsOpen());
+    EXPECT_THROW(mapped.Open("does not exist.shape"), std::runtime_error);
+}
+
+TEST_F(MappedShapeTest, InvalidIndices)
+{
+    auto Corrupt = [this](std::function<void(ShapeFormat::FileHeader& header, std::fstream& stream)> func)
+    {
+        std::fstream stream(m_fileName, std::ios::in | std::ios::out | std::ios::binary);
+        ShapeFormat::FileHeader header;
+        stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+        func(header, stream);
+    };
+    MappedShape mapped;
+
+    // twin of the first edge points past the edges
+    Corrupt([](ShapeFormat::FileHeader& header, std::fstream& stream)
+    {
+        const uint32_t twin = (uint32_t)header.m_edges.m_count;
+        stream.seekp(header.m_edges.m_offset + offsetof(ShapeFormat::PackedEdge, m_twin));
+        stream.write(reinterpret_cast<const char*>(&twin), sizeof(twin));
+    });
+    EXPECT_THROW(mapped.Open(m_fileName), std::runtime_error);
+    EXPECT_FALSE(mapped.IsOpen());
+
+    // edge range of the first face wraps around
+    SetUp();
+    Corrupt([](ShapeFormat::FileHeader& header, std::fstream& stream)
+    {
+        const uint32_t edgeCount = ShapeFormat::NoIndex;
+        stream.seekp(header.m_faces.m_offset + offsetof(ShapeFormat::PackedFace, m_edgeCount));
+        stream.write(reinterpret_cast<const char*>(&edgeCount), sizeof(edgeCount));
+    });
+    EXPECT_THROW(mapped.Open(m_fileName), std::runtime_error);
+
+    // face range of the first hull points past the faces
+    SetUp();
+    Corrupt([](ShapeFormat::FileHeader& header, std::fstream& stream)
+    {
+        const uint32_t firstFace = (uint32_t)header.m_faces.m_count;
+        stream.seekp(header.m_hulls.m_offset + offsetof(ShapeFormat::PackedHull, m_firstFace));
+        stream.write(reinterpret_cast<const char*>(&firstFace), sizeof(firstFace));
+    });
+    EXPECT_THROW(mapped.Open(m_fileName), std::runtime_error);
+
+    // the untouched file is fine
+    SetUp();
+    EXPECT_NO_THROW(mapped.Open(m_fileName));
+    EXPECT_TRUE(mapped.IsOpen());
+}
@@ -0,0 +1,68 @@
+#include "CommonTestFunctionality.h"
+#include <sstream>
+#include <thread>
+
+class ProfilingTest : public Test
+{
+protected:
+    virtual void SetUp()
+    {
+        Profiling::Reset();
+    }
+
+    virtual void TearDown()
+    {
+        Profiling::Reset();
+    }
+};
+
+TEST_F(ProfilingTest, ScopedTimer)
+{
+    {
+        Profiling::ScopedTimer timer("ProfilingTest::Outer");
+        timer.AddElements(3);
+        Profiling::ScopedTimer inner("ProfilingTest::Inner");
+        inner.AddElements(1);
+    }
+    std::thread thread([]()
+    {
+        Profiling::ScopedTimer timer("ProfilingTest::Inner");
+        timer.AddElements(2);
+    });
+    thread.join();
+
+    auto events = Profiling::GetEvents();
+    ASSERT_EQ(3, events.size());
+    EXPECT_STREQ("ProfilingTest::Outer", events[0].m_name);
+    EXPECT_LE(events[0].m_start, events[1].m_start);
+    EXPECT_LE(events[1].m_duration, events[0].m_duration);
+    EXPECT_EQ(events[0].m_thread, events[1].m_thread);
+    EXPECT_NE(events[0].m_thread, events[2].m_thread);
+
+    auto statistics = Profiling::GetStatistics();
+    ASSERT_EQ(2, statistics.size());
+    EXPECT_EQ(1, statistics["ProfilingTest::Outer"].m_calls);
+    EXPECT_EQ(3, statistics["ProfilingTest::Outer"].m_elements);
+    EXPECT_EQ(2, statistics["ProfilingTest::Inner"].m_calls);
+    EXPECT_EQ(3, statistics["ProfilingTest::Inner"].m_elements);
+    EXPECT_LE(statistics["ProfilingTest::Inner"].m_maxMs, statistics["ProfilingTest::Inner"].m_totalMs);
+
+    Profiling::Reset();
+    EXPECT_TRUE(Profiling::GetEvents().empty());
+}
+
+TEST_F(ProfilingTest, ChromeTrace)
+{
+    {
+        Profiling::ScopedTimer timer("ProfilingTest::\"Quoted\"");
+        timer.AddElements(42);
+    }
+    std::stringstream stream;
+    Profiling::WriteChromeTrace(stream);
+    const std::string trace = stream.str();
+    EXPECT_EQ(0, trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"ProfilingTest::\\\"Quoted\\\"\""));
+    EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"elements\":42}"));
+    EXPECT_EQ("]}\n", trace.substr(trace.size() - 3));
+}
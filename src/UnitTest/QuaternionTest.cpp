@@ -99,3 +99,68 @@ TEST_F(QuaternionTest, Transform)
 }
 
 
+
+TEST_F(QuaternionTest, TransformBatch)
+{
+    // not normalized, and an odd number of vectors
+    const Quat q = Quat(Vector3d(1, 2, 3).Normalized(), 0.7) * 3;
+    std::vector<Vector3d> vectors;
+    for (int i = 0; i < 7; ++i)
+    {
+        vectors.emplace_back(i, 1 - i * i, 0.5 * i);
+    }
+    std::vector<Vector3d> result(vectors.size());
+    q.Transform(vectors.data(), vectors.size(), result.data());
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        EXPECT_EQ(q.Transform(vectors[i]), result[i]);
+        EXPECT_EQ(RotationMatrix3d(q).Transform(vectors[i]), result[i]);
+    }
+    // in place
+    q.InverseTransform(result.data(), result.size(), result.data());
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        EXPECT_EQ(vectors[i], result[i]);
+    }
+}
+
+TEST_F(QuaternionTest, Slerp)
+{
+    const Quat q0;
+    const Quat q1(Vector3d(0, 0, 1), Constants::Pi / 2);
+    EXPECT_EQ(q0, Slerp(q0, q1, 0.0));
+    EXPECT_EQ(q1, Slerp(q0, q1, 1.0));
+    EXPECT_EQ(Quat(Vector3d(0, 0, 1), Constants::Pi / 4), Slerp(q0, q1, 0.5));
+    // the shortest path, -q1 is the same rotation as q1
+    const Quat end = -q1;
+    EXPECT_EQ(Quat(Vector3d(0, 0, 1), Constants::Pi / 4), Slerp(q0, end, 0.5));
+    EXPECT_EQ(-q1, end);
+    EXPECT_EQ(Quat(Vector3d(0, 0, 1), Constants::Pi / 4), Nlerp(q0, q1, 0.5));
+    EXPECT_EQ(Quat(Vector3d(0, 0, 1), Constants::Pi / 4), Nlerp(q0, end, 0.5));
+}
+
+TEST_F(QuaternionTest, InterpolateBatch)
+{
+    std::vector<Quat> q0, q1;
+    for (int i = 0; i < 5; ++i)
+    {
+        q0.emplace_back(Vector3d(1, i, 0).Normalized(), 0.3 * i);
+        q1.emplace_back(Vector3d(0, 1, i).Normalized(), 2 - 0.4 * i);
+    }
+    std::vector<Quat> result(q0.size());
+    for (double t : { -1.0, 0.0, 0.25, 0.5, 1.0 })
+    {
+        Slerp(q0.data(), q1.data(), q0.size(), t, result.data());
+        for (size_t i = 0; i < q0.size(); ++i)
+        {
+            EXPECT_EQ(Slerp(q0[i], q1[i], t), result[i]);
+        }
+        Nlerp(q0.data(), q1.data(), q0.size(), t, result.data());
+        for (size_t i = 0; i < q0.size(); ++i)
+        {
+            EXPECT_EQ(Nlerp(q0[i], q1[i], t), result[i]);
+            // nlerp approximates slerp
+            EXPECT_NEAR(1, std::abs(Slerp(q0[i], q1[i], t).InnerProduct(result[i])), 0.01);
+        }
+    }
+}
@@ -48,3 +48,80 @@ TEST_F(SQLiteTest, Query)
     }
     EXPECT_EQ(45, sum);
 }
+
+TEST_F(SQLiteTest, Blob)
+{
+    SQLite::DB db;
+    db.Open(":memory:",false);
+    db.ExecDML("CREATE TABLE a(Id INTEGER PRIMARY KEY,Data BLOB);");
+    std::vector<unsigned char> data(10000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (unsigned char)(i * 7);
+    }
+    // reserve the blob, then fill it in chunks
+    SQLite::Statement s = db.CompileStatement("INSERT INTO a(Id,Data) VALUES(?1,?2)");
+    s.Bind(1, 1);
+    s.BindZeroBlob(2, (int)data.size());
+    s.ExecDML();
+    SQLite::Blob blob = db.OpenBlob("a", "Data", 1, false);
+    EXPECT_EQ((int)data.size(), blob.GetSize());
+    for (int offset = 0; offset < (int)data.size(); offset += 4096)
+    {
+        blob.Write(&data[offset], std::min(4096, (int)data.size() - offset), offset);
+    }
+    blob.Close();
+    EXPECT_FALSE(blob.IsOpen());
+    // stream it back in chunks
+    blob = db.OpenBlob("a", "Data", 1);
+    std::vector<unsigned char> res(data.size());
+    for (int offset = 0; offset < (int)res.size(); offset += 1000)
+    {
+        blob.Read(&res[offset], 1000, offset);
+    }
+    EXPECT_EQ(data, res);
+    EXPECT_THROW(blob.Read(res.data(), 1, (int)res.size()), std::exception);
+    // zero-copy access
+    SQLite::Query q = db.ExecQuery("SELECT Data FROM a WHERE Id=1");
+    const unsigned char* field;
+    int length;
+    q.GetBlobField(0, field, length);
+    ASSERT_EQ((int)data.size(), length);
+    EXPECT_EQ(0, memcmp(field, data.data(), length));
+}
+
+TEST_F(SQLiteTest, Params)
+{
+    SQLite::DB db;
+    db.Open(":memory:",false);
+    db.ExecDMLParams("CREATE TABLE a(Name TEXT,Value INTEGER,Weight FLOAT,Data BLOB);");
+    const std::string name = "it's";
+    EXPECT_EQ(1, db.ExecDMLParams("INSERT INTO a(Name,Value,Weight,Data) VALUES(?,?,?,?)", name, 7, 0.5, std::vector<unsigned char>{ 1,2,3 }));
+    EXPECT_EQ(1, db.ExecDMLParams("INSERT INTO a(Name,Value,Weight,Data) VALUES(?,?,?,?)", "other", 8, 1.5, std::vector<unsigned char>()));
+    EXPECT_EQ(2, db.GetStatementCacheCount());
+    EXPECT_EQ(7, db.ExecSingleInt64Params("SELECT Value FROM a WHERE Name=?", name));
+    EXPECT_EQ(8, db.ExecSingleInt64Params("SELECT Value FROM a WHERE Name=?", "other"));
+    EXPECT_EQ(3, db.GetStatementCacheCount());
+    {
+        // a statement in use is taken out of the cache
+        SQLite::Query q = db.ExecQueryParams("SELECT Name,Weight,Data FROM a WHERE Value>=? ORDER BY Value", 7);
+        EXPECT_EQ(3, db.GetStatementCacheCount());
+        SQLite::Query q2 = db.ExecQueryParams("SELECT Name,Weight,Data FROM a WHERE Value>=? ORDER BY Value", 8);
+        ASSERT_FALSE(q.IsEOF());
+        EXPECT_EQ(name, q.GetStringField(0));
+        EXPECT_EQ(0.5, q.GetFloatField(1));
+        EXPECT_EQ(std::vector<unsigned char>({ 1,2,3 }), q.GetBlobField(2));
+        q.NextRow();
+        EXPECT_EQ("other", q.GetStringField(0));
+        q.NextRow();
+        EXPECT_TRUE(q.IsEOF());
+        ASSERT_FALSE(q2.IsEOF());
+        EXPECT_EQ("other", q2.GetStringField(0));
+    }
+    EXPECT_EQ(4, db.GetStatementCacheCount());
+    db.SetStatementCacheSize(2);
+    EXPECT_EQ(2, db.GetStatementCacheCount());
+    EXPECT_EQ("other", db.ExecSingleStringParams("SELECT Name FROM a WHERE Value=?", 8));
+    EXPECT_EQ(2, db.GetStatementCacheCount());
+    EXPECT_THROW(db.ExecDMLParams("INSERT INTO b VALUES(?)", 1), std::exception);
+}
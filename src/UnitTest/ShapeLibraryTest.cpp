@@ -0,0 +1,137 @@
+#include "CommonTestFunctionality.h"
+#include <cstdio>
+
+class ShapeLibraryTest : public Test
+{
+protected:
+    virtual void SetUp()
+    {
+        std::remove(m_fileName);
+        m_dodecahedron = Construct<Dodecahedron>();
+        m_dodecahedron->SplitTrianglesIn4();
+        m_dodecahedron->SetBoundingShape(BoundingShape3d(Vector3d(0, 0, 0), 2.0));
+        m_dodecahedron->ForEachHull([](const HullRaw& hull) { hull->CalculateBoundingShape(BoundingShape3d::Type::Box); });
+        m_cube = Construct<Cube>();
+    }
+
+    virtual void TearDown()
+    {
+        std::remove(m_fileName);
+    }
+
+    size_t FaceCount(const ShapePtr& shape)
+    {
+        size_t count = 0;
+        shape->ForEachFace([&count](const FaceRaw& face) { ++count; });
+        return count;
+    }
+
+    const char* m_fileName = "ShapeLibraryTest.db";
+    ShapePtr m_dodecahedron;
+    ShapePtr m_cube;
+};
+
+TEST_F(ShapeLibraryTest, AddRetrieve)
+{
+    ShapeLibrary library;
+    library.Open(m_fileName, false);
+    const int64_t id0 = library.Add("dodecahedron", *m_dodecahedron);
+    const int64_t id1 = library.Add("cube", *m_cube);
+    auto shapes = library.GetShapes();
+    ASSERT_EQ(2, shapes.size());
+    EXPECT_EQ(id0, shapes[0].m_id);
+    EXPECT_EQ("dodecahedron", shapes[0].m_name);
+    EXPECT_EQ(id1, shapes[1].m_id);
+    EXPECT_EQ("cube", shapes[1].m_name);
+
+    for (bool lazy : { true, false })
+    {
+        ShapePtr dodecahedron = library.Retrieve(id0, lazy);
+        ShapePtr cube = library.Retrieve(id1, lazy);
+        EXPECT_EQ(m_dodecahedron->GetBoundingShape(), dodecahedron->GetBoundingShape());
+        EXPECT_EQ(m_dodecahedron->GetHulls().size(), dodecahedron->GetHulls().size());
+        dodecahedron->ForEachHull([lazy](const HullRaw& hull)
+        {
+            EXPECT_EQ(!lazy, hull->IsLoaded());
+            EXPECT_EQ(BoundingShape3d::Type::Box, hull->GetBoundingShape().GetType());
+        });
+        // hulls stored without bounding shape got one
+        cube->ForEachHull([](const HullRaw& hull) { EXPECT_NE(BoundingShape3d::Type::Unknown, hull->GetBoundingShape().GetType()); });
+
+        EXPECT_EQ(FaceCount(m_dodecahedron), FaceCount(dodecahedron));
+        EXPECT_NEAR(m_dodecahedron->CalculateVolume(), dodecahedron->CalculateVolume(), 1e-9);
+        EXPECT_NEAR(m_cube->CalculateVolume(), cube->CalculateVolume(), 1e-9);
+        dodecahedron->ForEachHull([](const HullRaw& hull) { EXPECT_TRUE(hull->IsLoaded()); });
+        dodecahedron->ForEachEdge([](const EdgeRaw& edge) { EXPECT_EQ(edge, edge->GetTwin()->GetTwin()); });
+    }
+    EXPECT_THROW(library.Retrieve(id1 + 1), std::runtime_error);
+}
+
+TEST_F(ShapeLibraryTest, LoadAfterClose)
+{
+    ShapePtr shape;
+    {
+        ShapeLibrary library;
+        library.Open(m_fileName, false);
+        shape = library.Retrieve(library.Add("dodecahedron", *m_dodecahedron));
+    }
+    // the proxy hulls keep the connection
+    EXPECT_NEAR(m_dodecahedron->CalculateVolume(), shape->CalculateVolume(), 1e-9);
+}
+
+TEST_F(ShapeLibraryTest, RemoveReopen)
+{
+    int64_t id0, id1;
+    {
+        ShapeLibrary library;
+        library.Open(m_fileName, false);
+        id0 = library.Add("dodecahedron", *m_dodecahedron);
+        id1 = library.Add("cube", *m_cube);
+        ShapePtr proxy = library.Retrieve(id0);
+        library.Remove(id0);
+        EXPECT_THROW(proxy->CalculateVolume(), std::runtime_error);
+    }
+    ShapeLibrary library;
+    library.Open(m_fileName, true);
+    auto shapes = library.GetShapes();
+    ASSERT_EQ(1, shapes.size());
+    EXPECT_EQ(id1, shapes[0].m_id);
+    EXPECT_NEAR(m_cube->CalculateVolume(), library.Retrieve(id1)->CalculateVolume(), 1e-9);
+    EXPECT_THROW(library.Retrieve(id0), std::runtime_error);
+
+    // only the bounding shapes of the cube (and the unknown one) are left
+    SQLite::DB db;
+    db.Open(m_fileName, true);
+    EXPECT_EQ(1 + (int64_t)m_cube->GetHulls().size(), db.ExecSingleInt64("SELECT COUNT(*) FROM BoundingShapes"));
+}
+
+TEST_F(ShapeLibraryTest, RetrieveRollback)
+{
+    ShapeLibrary library;
+    library.Open(m_fileName, false);
+    const int64_t id = library.Add("cube", *m_cube);
+
+    // hide a table the query needs
+    SQLite::DB db;
+    db.Open(m_fileName, false);
+    db.ExecDML("ALTER TABLE BoundingShapes RENAME TO Hidden");
+    EXPECT_THROW(library.Retrieve(id), std::exception);
+
+    // the failed retrieve left no transaction (or lock) behind
+    EXPECT_NO_THROW(db.ExecDML("ALTER TABLE Hidden RENAME TO BoundingShapes"));
+    EXPECT_NO_THROW(library.Remove(id));
+    EXPECT_TRUE(library.GetShapes().empty());
+}
+
+TEST_F(ShapeLibraryTest, OpenInvalid)
+{
+    {
+        SQLite::DB db;
+        db.Open(m_fileName, false);
+        m_cube->Store(db);
+    }
+    ShapeLibrary library;
+    EXPECT_THROW(library.Open(m_fileName, false), std::runtime_error);
+    EXPECT_FALSE(library.IsOpen());
+    EXPECT_THROW(library.GetShapes(), std::runtime_error);
+}
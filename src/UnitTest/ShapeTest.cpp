@@ -1,5 +1,6 @@
 #include "CommonTestFunctionality.h"
 #include "SQLiteDB.h"
+#include <sstream>
 
 class ShapeTest : public Test 
 {
@@ -47,6 +48,367 @@ TEST_F(ShapeTest, Copy)
 
 }
 
+TEST_F(ShapeTest, Instance)
+{
+    auto InstanceShape = [](ShapePtr d)
+    {
+        std::set<VertexRaw> vertices;
+        std::set<EdgeRaw> edges;
+        d->ForEachVertex([&vertices](const VertexRaw& vertex) { vertices.emplace(vertex); });
+        d->ForEachEdge([&edges](const EdgeRaw& edge) { edges.emplace(edge); });
+        size_t vc0 = vertices.size();
+        size_t ec0 = edges.size();
+        ShapePtr s0 = d->Instance();
+        // geometry is shared
+        s0->ForEachVertex([&vertices](const VertexRaw& vertex) { vertices.emplace(vertex); });
+        s0->ForEachEdge([&edges](const EdgeRaw& edge) { edges.emplace(edge); });
+        ASSERT_EQ(vc0, vertices.size());
+        ASSERT_EQ(ec0, edges.size());
+        // until it is materialized
+        s0->ForEachHull([](const HullRaw& hull) { hull->Materialize(); });
+        s0->ForEachVertex([&vertices](const VertexRaw& vertex) { vertices.emplace(vertex); });
+        s0->ForEachEdge([&edges](const EdgeRaw& edge) { edges.emplace(edge); });
+        ASSERT_EQ(vc0 * 2, vertices.size());
+        ASSERT_EQ(ec0 * 2, edges.size());
+    };
+
+    InstanceShape(Construct<Cube>());
+    InstanceShape(Construct<Dodecahedron>());
+}
+
+TEST_F(ShapeTest, CopyOnWrite)
+{
+    ShapePtr s0 = Construct<Cube>();
+    ShapePtr s1 = s0->Instance();
+    s1->Scale(2);
+    s1->Translate({ 5,0,0 });
+    s1->Rotate(Quat(Vector3d(0, 0, 1), 0.5));
+    EXPECT_NEAR(8.0, s0->CalculateVolume(), 0.01);
+    EXPECT_NEAR(64.0, s1->CalculateVolume(), 0.01);
+    // modifying the copy leaves the original untouched
+    s1->Triangulate();
+    EXPECT_EQ(6, FaceCount(s0));
+    EXPECT_EQ(12, FaceCount(s1));
+    EXPECT_NEAR(8.0, s0->CalculateVolume(), 0.01);
+    EXPECT_NEAR(64.0, s1->CalculateVolume(), 0.01);
+    s1->ForEachHull([](const HullRaw& hull) { EXPECT_FALSE(hull->IsInstance()); });
+    double maxX = 0;
+    s1->ForEachVertex([&maxX](const VertexRaw& vertex) { maxX = std::max(maxX, (double)(*vertex)[0]); });
+    EXPECT_LT(6.5, maxX);
+    s0->ForEachVertex([](const VertexRaw& vertex) { EXPECT_NEAR(1.0, fabs((*vertex)[0]), 1e-9); });
+}
+
+TEST_F(ShapeTest, CopyOnWriteSource)
+{
+    // the original keeps its faces, and modifying it leaves the copies untouched
+    ShapePtr s0 = Construct<Cube>();
+    ShapePtr s1 = s0->Instance();
+    ShapePtr s2 = s1->Instance();
+    HullRaw hull = *s0->GetHulls().begin();
+    EXPECT_FALSE(hull->IsInstance());
+    s0->ForEachFace([&hull](const FaceRaw& face) { EXPECT_EQ(hull, face->GetHull()); });
+
+    // face level edits
+    FaceRaw face = *hull->GetFaces().begin();
+    face->Split();
+    EXPECT_EQ(7, FaceCount(s0));
+    EXPECT_EQ(6, FaceCount(s1));
+    EXPECT_EQ(6, FaceCount(s2));
+    s1->ForEachHull([](const HullRaw& hull) { EXPECT_FALSE(hull->IsInstance()); });
+    s2->ForEachHull([](const HullRaw& hull) { EXPECT_FALSE(hull->IsInstance()); });
+
+    // transformations
+    ShapePtr s3 = s0->Instance();
+    s0->Scale(2);
+    EXPECT_NEAR(64.0, s0->CalculateVolume(), 0.01);
+    EXPECT_NEAR(8.0, s3->CalculateVolume(), 0.01);
+    EXPECT_EQ(7, FaceCount(s3));
+}
+
+TEST_F(ShapeTest, InstanceRemoveFace)
+{
+    // removing a face of the shared geometry from an instance removes its private copy
+    ShapePtr s0 = Construct<Cube>();
+    ShapePtr s1 = s0->Instance();
+    HullRaw hull = *s1->GetHulls().begin();
+    ASSERT_TRUE(hull->IsInstance());
+    hull->RemoveFace(*hull->GetFaces().begin());
+    EXPECT_FALSE(hull->IsInstance());
+    EXPECT_EQ(6, FaceCount(s0));
+    EXPECT_EQ(5, FaceCount(s1));
+    s1->ForEachFace([&hull](const FaceRaw& face) { EXPECT_EQ(hull, face->GetHull()); });
+}
+
+TEST_F(ShapeTest, TransformBoundingShapes)
+{
+    ShapePtr shape = Construct<Cube>();
+    shape->SetBoundingShape(BoundingShape3d(Vector3d(0, 0, 0), 2.0));
+    shape->Scale(2);
+    shape->Translate(Vector3d(1, 2, 3));
+    shape->Rotate(Quat(Vector3d(1, 1, 1).Normalized(), 0.5));
+    EXPECT_DOUBLE_EQ(4, shape->GetBoundingShape().GetRadius());
+    shape->ForEachHull([](const HullRaw& hull)
+    {
+        const BoundingShape3d boundingShape = hull->GetBoundingShape();
+        EXPECT_FALSE(boundingShape.IsOptimal());
+        hull->ForEachVertex([&boundingShape](const VertexRaw& vertex) { EXPECT_TRUE(boundingShape.Encapsulates(*vertex)); });
+    });
+
+    shape->RefineBoundingShapes();
+    shape->ForEachHull([](const HullRaw& hull)
+    {
+        const BoundingShape3d boundingShape = hull->GetBoundingShape();
+        BoundingShape3d calculated = boundingShape;
+        const auto& vertices = hull->GetVertices();
+        calculated.Set(BoundingShape3d::Type::Box, vertices.begin(), vertices.end());
+        EXPECT_TRUE(boundingShape.IsOptimal());
+        EXPECT_EQ(calculated.GetMin(), boundingShape.GetMin());
+        EXPECT_EQ(calculated.GetMax(), boundingShape.GetMax());
+    });
+}
+
+TEST_F(ShapeTest, DeriveBoundingShape)
+{
+    ShapePtr shape = Construct<Cube>();
+    ShapePtr other = Construct<Cube>();
+    other->Translate(Vector3d(3, 0, 0));
+    shape->DeriveBoundingShape(BoundingShape3d::Type::Box);
+    const BoundingShape3d box = shape->GetBoundingShape();
+    ASSERT_EQ(BoundingShape3d::Type::Box, box.GetType());
+
+    // follows added and transformed hulls
+    const HullPtr hull = *other->GetHulls().begin();
+    shape->AddHull(hull);
+    EXPECT_DOUBLE_EQ(box.GetMax()[0] + 3, shape->GetBoundingShape().GetMax()[0]);
+    hull->Translate(Vector3d(1, 0, 0));
+    EXPECT_DOUBLE_EQ(box.GetMax()[0] + 4, shape->GetBoundingShape().GetMax()[0]);
+    shape->RemoveHull(hull);
+    EXPECT_EQ(box, shape->GetBoundingShape());
+
+    shape->DeriveBoundingShape(BoundingShape3d::Type::Ball);
+    shape->ForEachVertex([&shape](const VertexRaw& vertex) { EXPECT_TRUE(shape->GetBoundingShape().Encapsulates(*vertex)); });
+    EXPECT_THROW(shape->DeriveBoundingShape(BoundingShape3d::Type::OrientedBox), std::runtime_error);
+
+    shape->SetBoundingShape(BoundingShape3d());
+    shape->AddHull(hull);
+    EXPECT_FALSE(shape->GetBoundingShape().IsInitialized());
+}
+
+TEST_F(ShapeTest, StoreRetrieveModes)
+{
+    ShapePtr shape0 = Construct<Dodecahedron>();
+    shape0->SplitTrianglesIn4();
+    shape0->SetColor(Construct<Color>(1.0f, 0.0f, 0.0f, 1.0f));
+    for (auto mode : { Shape::StorageMode::Rows, Shape::StorageMode::BulkRows, Shape::StorageMode::Blobs })
+    {
+        SQLite::DB db;
+        db.Open(":memory:", false);
+        shape0->Store(db, mode);
+        EXPECT_EQ(mode == Shape::StorageMode::Blobs ? 2 : 1, db.ExecSingleInt64("SELECT Value FROM Header WHERE Key='Version'"));
+        ShapePtr shape1 = Construct<Shape>();
+        shape1->Retrieve(db);
+        EXPECT_EQ(FaceCount(shape0), FaceCount(shape1));
+        EXPECT_NEAR(shape0->CalculateVolume(), shape1->CalculateVolume(), 1e-9);
+        shape1->ForEachHull([](const HullRaw& hull) { EXPECT_EQ(Color(1.0f, 0.0f, 0.0f, 1.0f), *hull->GetColor()); });
+        shape1->ForEachEdge([](const EdgeRaw& edge) { EXPECT_EQ(edge, edge->GetTwin()->GetTwin()); });
+    }
+}
+
+TEST_F(ShapeTest, StoreRetrieveOrientedBox)
+{
+    ShapePtr shape0 = Construct<Dodecahedron>();
+    shape0->ForEachHull([](const HullRaw& hull) { hull->Rotate(Quat(Vector3d(1, 1, 0).Normalized(), 0.3)); hull->CalculateBoundingShape(BoundingShape3d::Type::OrientedBox); });
+    const BoundingShape3d boundingShape = (*shape0->GetHulls().begin())->GetBoundingShape();
+    ASSERT_EQ(BoundingShape3d::Type::OrientedBox, boundingShape.GetType());
+    for (auto mode : { Shape::StorageMode::Rows, Shape::StorageMode::Blobs })
+    {
+        SQLite::DB db;
+        db.Open(":memory:", false);
+        shape0->Store(db, mode);
+        ShapePtr shape1 = Construct<Shape>();
+        shape1->Retrieve(db);
+        const BoundingShape3d retrieved = (*shape1->GetHulls().begin())->GetBoundingShape();
+        ASSERT_EQ(BoundingShape3d::Type::OrientedBox, retrieved.GetType());
+        EXPECT_NEAR(boundingShape.CalculateVolume(), retrieved.CalculateVolume(), 1e-12);
+        for (int k = 0; k < 3; ++k)
+        {
+            EXPECT_NEAR(0, Distance(boundingShape.GetAxes()[k], retrieved.GetAxes()[k]), 1e-12);
+        }
+    }
+}
+
+TEST_F(ShapeTest, StoreRetrieveFile)
+{
+    // a file db; the other tests use in-memory dbs
+    const char* fileName = "ShapeTest.db";
+    ShapePtr shape0 = Construct<Dodecahedron>();
+    shape0->SplitTrianglesIn4();
+    for (auto mode : { Shape::StorageMode::Rows, Shape::StorageMode::BulkRows, Shape::StorageMode::Blobs })
+    {
+        std::remove(fileName);
+        SQLite::DB db;
+        db.Open(fileName, false);
+        shape0->Store(db, mode);
+        ShapePtr shape1 = Construct<Shape>();
+        Shape::RetrieveTimings timings;
+        shape1->Retrieve(db, &timings);
+        // bulk pragmas are scoped to Store
+        EXPECT_EQ("delete", db.ExecSingleString("PRAGMA journal_mode"));
+        db.Close();
+        EXPECT_EQ(FaceCount(shape0), FaceCount(shape1));
+        EXPECT_NEAR(shape0->CalculateVolume(), shape1->CalculateVolume(), 1e-9);
+        shape1->ForEachEdge([](const EdgeRaw& edge) { EXPECT_EQ(edge, edge->GetTwin()->GetTwin()); });
+        EXPECT_LE(timings.m_header, timings.m_total);
+        EXPECT_GE(timings.m_read, 0.0);
+    }
+    std::remove(fileName);
+}
+
+TEST_F(ShapeTest, RetrieveInvalid)
+{
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    db.ExecDML("CREATE TABLE Header(Key TEXT PRIMARY KEY,Value) WITHOUT ROWID");
+    db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Type','Shape')");
+    db.ExecDML("INSERT INTO Header(Key,Value) VALUES('Version',99)");
+    ShapePtr shape = Construct<Shape>();
+    EXPECT_THROW(shape->Retrieve(db), std::runtime_error);
+    EXPECT_NO_THROW(db.BeginTransaction());
+    db.RollbackTransaction();
+}
+
+TEST_F(ShapeTest, Validate)
+{
+    ShapePtr shape = Construct<Dodecahedron>();
+    shape->SplitTrianglesIn4();
+    const Hull::ValidationReport report = shape->Validate();
+    EXPECT_TRUE(report.IsValid()) << report.ToString();
+    EXPECT_EQ((size_t)FaceCount(shape), report.m_faces);
+    EXPECT_EQ(3 * report.m_faces, report.m_edges);
+
+    // the checksum depends on the geometry only
+    ShapePtr copy = Construct<Shape>();
+    shape->GetHulls().begin()->get()->Copy(*copy);
+    EXPECT_EQ(report.m_checksum, copy->Validate().m_checksum);
+    copy->Translate(Vector3d(1, 0, 0));
+    EXPECT_NE(report.m_checksum, copy->Validate().m_checksum);
+
+    // break a twin
+    EdgeRaw edge = (*shape->GetHulls().begin())->GetFaces().begin()->get()->GetStartEdge();
+    EdgeRaw twin = edge->GetTwin();
+    edge->SetTwin(edge->GetNext());
+    const Hull::ValidationReport broken = shape->Validate();
+    EXPECT_FALSE(broken.IsValid());
+    EXPECT_EQ(2, broken.m_unpairedTwins);
+    EXPECT_THROW(broken.Check("broken"), std::runtime_error);
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    EXPECT_THROW(shape->Store(db), std::runtime_error);
+    edge->SetTwin(twin);
+    EXPECT_TRUE(shape->Validate().IsValid());
+}
+
+TEST_F(ShapeTest, RetrieveChecksum)
+{
+    ShapePtr shape = Construct<Dodecahedron>();
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    shape->Store(db, Shape::StorageMode::Rows);
+    db.ExecDML("UPDATE Vertices SET x=x+0.5 WHERE Id=1");
+    ShapePtr retrieved = Construct<Shape>();
+    EXPECT_THROW(retrieved->Retrieve(db), std::runtime_error);
+    EXPECT_TRUE(retrieved->GetHulls().empty());
+}
+
+TEST_F(ShapeTest, RetrieveCorruptBlob)
+{
+    ShapePtr shape = Construct<Dodecahedron>();
+    // a blob which isn't a whole number of edges, and edges which don't form the faces
+    for (const char* edges : { "X'00'", "substr(Edges,1,32)" })
+    {
+        SQLite::DB db;
+        db.Open(":memory:", false);
+        shape->Store(db, Shape::StorageMode::Blobs);
+        db.ExecDML("UPDATE Hulls SET Edges=%1% WHERE Id=1", edges);
+        ShapePtr retrieved = Construct<Shape>();
+        EXPECT_THROW(retrieved->Retrieve(db), std::runtime_error);
+        EXPECT_TRUE(retrieved->GetHulls().empty());
+        // the transaction was rolled back
+        EXPECT_NO_THROW(db.BeginTransaction());
+        db.RollbackTransaction();
+    }
+}
+
+TEST_F(ShapeTest, StoreRetrieveInstance)
+{
+    ShapePtr s0 = Construct<Cube>();
+    ShapePtr s1 = s0->Instance();
+    s1->Scale(0.5);
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    s1->Store(db);
+    ShapePtr s2 = Construct<Shape>();
+    s2->Retrieve(db);
+    EXPECT_NEAR(1.0, s2->CalculateVolume(), 0.01);
+    EXPECT_EQ(6, FaceCount(s2));
+}
+
+TEST_F(ShapeTest, StoreDelta)
+{
+    // two hulls: a cube and a translated copy of it
+    ShapePtr s0 = Construct<Cube>();
+    HullPtr a = *s0->GetHulls().begin();
+    HullPtr b = a->Copy(*s0);
+    b->Translate(Vector3d(3, 0, 0));
+    SQLite::DB db;
+    db.Open(":memory:", false);
+    s0->Store(db, Shape::StorageMode::Delta); // nothing stored yet: full store
+    EXPECT_EQ(2, db.ExecSingleInt64("SELECT COUNT(*) FROM Hulls"));
+    EXPECT_FALSE(a->IsModifiedSinceStore());
+    EXPECT_FALSE(b->IsModifiedSinceStore());
+
+    // mark the rows, a rewritten row loses its mark
+    auto Marked = [&db](const HullPtr& hull) { return 7 == db.ExecSingleInt64Params("SELECT Shape FROM Hulls WHERE Id=?1", hull->GetStoreId()); };
+    db.ExecDML("UPDATE Hulls SET Shape=7");
+
+    b->SetColor(Construct<Color>(0.0f, 1.0f, 0.0f, 1.0f));
+    EXPECT_TRUE(b->IsModifiedSinceStore());
+    s0->Store(db, Shape::StorageMode::Delta);
+    EXPECT_TRUE(Marked(a));
+    EXPECT_FALSE(Marked(b));
+
+    // removed and added hulls
+    s0->RemoveHull(a);
+    HullPtr c = b->Copy(*s0);
+    c->Translate(Vector3d(0, 3, 0));
+    s0->Store(db, Shape::StorageMode::Delta);
+    EXPECT_EQ(2, db.ExecSingleInt64("SELECT COUNT(*) FROM Hulls"));
+    EXPECT_EQ(0, db.ExecSingleInt64Params("SELECT COUNT(*) FROM Hulls WHERE Id=?1", a->GetStoreId()));
+    EXPECT_NE(b->GetStoreId(), c->GetStoreId());
+
+    // a retrieved shape continues with delta stores
+    ShapePtr s1 = Construct<Shape>();
+    s1->Retrieve(db);
+    EXPECT_EQ(12, FaceCount(s1));
+    EXPECT_NEAR(s0->CalculateVolume(), s1->CalculateVolume(), 1e-9);
+    db.ExecDML("UPDATE Hulls SET Shape=7");
+    HullPtr d = *s1->GetHulls().begin();
+    d->Scale(0.5);
+    s1->Store(db, Shape::StorageMode::Delta);
+    EXPECT_EQ(1, db.ExecSingleInt64("SELECT COUNT(*) FROM Hulls WHERE Shape=7"));
+    EXPECT_FALSE(Marked(d));
+    // no bounding shapes left behind
+    EXPECT_EQ(0, db.ExecSingleInt64("SELECT COUNT(*) FROM BoundingShapes WHERE Id<>0 AND Id NOT IN (SELECT BoundingShape FROM Hulls UNION SELECT BoundingShape FROM Shapes)"));
+
+    // s0 no longer matches the db: full store
+    db.ExecDML("UPDATE Hulls SET Shape=7");
+    s0->Store(db, Shape::StorageMode::Delta);
+    EXPECT_EQ(0, db.ExecSingleInt64("SELECT COUNT(*) FROM Hulls WHERE Shape=7"));
+    ShapePtr s2 = Construct<Shape>();
+    s2->Retrieve(db);
+    EXPECT_NEAR(s0->CalculateVolume(), s2->CalculateVolume(), 1e-9);
+}
+
 TEST_F(ShapeTest, SplitTrianglesIn4)
 {
     ShapePtr shape = Construct<Cube>();
@@ -56,10 +418,79 @@ TEST_F(ShapeTest, SplitTrianglesIn4)
     EXPECT_EQ(48, FaceCount(shape));
 }
 
+TEST_F(ShapeTest, UpdateNormals)
+{
+    ShapePtr shape = Construct<Cube>();
+    HullRaw hull = *shape->GetHulls().begin();
+    FaceRaw face = *hull->GetFaces().begin();
+    EXPECT_FALSE(face->IsNormalOutdated());
+    const Normal expected = *face->GetNormal();
+    const Normal* object = face->GetNormal().get();
+
+    // only outdated normals are calculated
+    *face->GetNormal() = Normal(0.6, 0.8, 0);
+    hull->UpdateNormals();
+    EXPECT_EQ(Normal(0.6, 0.8, 0), *face->GetNormal());
+    hull->InvalidateNormals();
+    EXPECT_TRUE(face->IsNormalOutdated());
+    hull->UpdateNormals();
+    EXPECT_FALSE(face->IsNormalOutdated());
+    EXPECT_EQ(expected, *face->GetNormal());
+    EXPECT_EQ(object, face->GetNormal().get());
+
+    // new faces
+    shape->Triangulate();
+    shape->SplitTrianglesIn4();
+    shape->ForEachFace([](const FaceRaw& face)
+    {
+        EXPECT_FALSE(face->IsNormalOutdated());
+        EXPECT_EQ(face->CalculateNormal(), *face->GetNormal());
+    });
+    const Hull::ValidationReport report = shape->Validate();
+    EXPECT_TRUE(report.IsValid()) << report.ToString();
+}
+
+TEST_F(ShapeTest, VertexNormals)
+{
+    // the corners of a cube get the direction of the corner, with or without triangulation
+    auto CheckCube = [](const Shape& shape)
+    {
+        shape.ForEachEdge([](const EdgeRaw& edge)
+        {
+            ASSERT_TRUE(edge->GetStartNormal());
+            EXPECT_EQ(Normal(*edge->GetStartVertex()).Normalized(), *edge->GetStartNormal());
+            edge->ForEachEdgeAtStartVertex([&edge](const EdgeRaw& other) { EXPECT_EQ(edge->GetStartNormal(), other->GetStartNormal()); });
+        });
+    };
+    ShapePtr cube = Construct<Cube>();
+    HullRaw hull = *cube->GetHulls().begin();
+    hull->UpdateNormals(Hull::VertexNormals::AreaWeighted);
+    CheckCube(*cube);
+    const Normal* object = hull->GetFaces().begin()->get()->GetStartEdge()->GetStartNormal().get();
+    hull->InvalidateNormals();
+    hull->UpdateNormals(Hull::VertexNormals::AngleWeighted);
+    CheckCube(*cube);
+    EXPECT_EQ(object, hull->GetFaces().begin()->get()->GetStartEdge()->GetStartNormal().get());
+
+    ShapePtr triangulated = Construct<Cube>();
+    triangulated->Triangulate();
+    (*triangulated->GetHulls().begin())->UpdateNormals(Hull::VertexNormals::AngleWeighted);
+    CheckCube(*triangulated);
+
+    // a refined dodecahedron is a sphere
+    ShapePtr sphere = Construct<Dodecahedron>(1000);
+    sphere->ForEachEdge([](const EdgeRaw& edge)
+    {
+        ASSERT_TRUE(edge->GetStartNormal());
+        EXPECT_NEAR(1, edge->GetStartNormal()->InnerProduct(Normal(*edge->GetStartVertex())), 1e-2);
+    });
+    EXPECT_TRUE(sphere->Validate().IsValid());
+}
+
 TEST_F(ShapeTest, StoreRetrieve)
 {
     ShapePtr shape0 = Construct<Cube>();
-    shape0->SetBoundingShape(BoundingShape3d(Vertex(1, 2, 3), Vertex(4, 5, 6)));
+    shape0->SetBoundingShape(BoundingShape3d(Vector3d(1, 2, 3), Vector3d(4, 5, 6)));
     SQLite::DB db;
     db.Open(":memory:",false);
     shape0->Store(db);
@@ -78,6 +509,36 @@ TEST_F(ShapeTest, StoreRetrieve)
     ASSERT_EQ(shape0->GetBoundingShape(),shape1->GetBoundingShape());
 }
 
+TEST_F(ShapeTest, SaveLoad)
+{
+    ShapePtr shape0 = Construct<Dodecahedron>();
+    shape0->SplitTrianglesIn4();
+    shape0->SetBoundingShape(BoundingShape3d(Vector3d(1, 2, 3), 4.0));
+    shape0->ForEachHull([](const HullRaw& hull) { hull->CalculateBoundingShape(); });
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    shape0->Save(stream);
+    ShapePtr shape1 = Construct<Shape>();
+    shape1->Load(stream);
+    std::set<VertexRaw> vertices0, vertices1;
+    shape0->ForEachVertex([&vertices0](const VertexRaw& vertex) { vertices0.emplace(vertex); });
+    shape1->ForEachVertex([&vertices1](const VertexRaw& vertex) { vertices1.emplace(vertex); });
+    EXPECT_EQ(vertices0.size(), vertices1.size());
+    EXPECT_EQ(FaceCount(shape0), FaceCount(shape1));
+    EXPECT_NEAR(shape0->CalculateVolume(), shape1->CalculateVolume(), 1e-9);
+    EXPECT_EQ(shape0->GetBoundingShape(), shape1->GetBoundingShape());
+    EXPECT_EQ((*shape0->GetHulls().begin())->GetBoundingShape(), (*shape1->GetHulls().begin())->GetBoundingShape());
+    // twins have to be restored as well
+    shape1->ForEachEdge([](const EdgeRaw& edge) { EXPECT_EQ(edge, edge->GetTwin()->GetTwin()); });
+}
+
+TEST_F(ShapeTest, LoadInvalid)
+{
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    stream << "not a shape";
+    ShapePtr shape = Construct<Shape>();
+    EXPECT_THROW(shape->Load(stream), std::runtime_error);
+}
+
 TEST_F(ShapeTest, Volume)
 {
     auto s = Construct<Cube>();
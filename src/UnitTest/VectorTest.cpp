@@ -128,3 +128,78 @@ TEST_F(VectorTest, VectorTripleProduct)
     EXPECT_EQ(-29,v3[1]);
     EXPECT_EQ( 18,v3[2]);
 }
+
+TEST_F(VectorTest, ConvertPrecision)
+{
+    const Vector3d v0(1.5, -2.25, 1.0 / 3);
+    const Vector3f v1(v0);
+    EXPECT_EQ(1.5f, v1[0]);
+    EXPECT_EQ(-2.25f, v1[1]);
+    EXPECT_EQ((float)(1.0 / 3), v1[2]);
+    const Vector3d v2(v1);
+    EXPECT_EQ(v0[0], v2[0]);
+    EXPECT_NEAR(v0[2], v2[2], 1e-7);
+}
+
+TEST_F(VectorTest, PackedNormal)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<Vector3d> normals = { Vector3d(1, 0, 0), Vector3d(0, -1, 0), Vector3d(0, 0, 1), Vector3d(0, 0, -1), Vector3d(-1, -1, -1).Normalized() };
+    for (int i = 0; i < 1000; ++i)
+    {
+        normals.emplace_back(Vector3d(distribution(generator), distribution(generator), distribution(generator)).Normalized());
+    }
+    for (const Vector3d& normal : normals)
+    {
+        const Vector3d octahedral(PackedNormal::DecodeOctahedral(PackedNormal::EncodeOctahedral(Normal(normal))));
+        EXPECT_NEAR(1, octahedral.Length(), 1e-6);
+        EXPECT_LT(Distance(normal, octahedral), 1e-4);
+        const Vector3d packed(PackedNormal::Decode1010102(PackedNormal::Encode1010102(Normal(normal))));
+        EXPECT_NEAR(1, packed.Length(), 1e-6);
+        EXPECT_LT(Distance(normal, packed), 4e-3);
+    }
+    // GL_INT_2_10_10_10_REV layout
+    EXPECT_EQ(0x1FFu | (0x201u << 10), PackedNormal::Encode1010102(Normal(Vector3d(1, -1, 0).Normalized() * std::sqrt(2.0))));
+}
+
+TEST_F(VectorTest, Batch)
+{
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> distribution(-10, 10);
+    std::vector<Vector3d> vectors;
+    for (int i = 0; i < 301; ++i)
+    {
+        vectors.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+    }
+    const Vector3d point(1, -2, 3);
+    std::vector<double> result(vectors.size());
+    VectorBatch::DistancesSquared(vectors.data(), vectors.size(), point, result.data());
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        EXPECT_EQ(DistanceSquared(vectors[i], point), result[i]);
+    }
+    VectorBatch::InnerProducts(vectors.data(), vectors.size(), point, result.data());
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        EXPECT_EQ(vectors[i].InnerProduct(point), result[i]);
+    }
+
+    size_t farthest = 0;
+    for (size_t i = 1; i < vectors.size(); ++i)
+    {
+        if (DistanceSquared(vectors[i], point) > DistanceSquared(vectors[farthest], point))
+        {
+            farthest = i;
+        }
+    }
+    EXPECT_EQ(farthest, VectorBatch::Farthest(vectors.data(), vectors.size(), point));
+    // generic version
+    std::vector<Vector2f> vectors2;
+    for (const Vector3d& v : vectors)
+    {
+        vectors2.emplace_back((float)v[0], (float)v[1]);
+    }
+    vectors2.emplace_back(100.0f, 0.0f);
+    EXPECT_EQ(vectors2.size() - 1, VectorBatch::Farthest(vectors2.data(), vectors2.size(), Vector2f(0.0f, 0.0f)));
+}
@@ -0,0 +1,115 @@
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VECTORBATCH_SSE2
+#endif
+using namespace std;
+
+#include "Geometry.h"
+using namespace Geometry;
+
+static_assert(sizeof(Vector3d) == 3 * sizeof(double), "Vector3d arrays are expected to be packed doubles");
+
+namespace
+{
+#ifdef VECTORBATCH_SSE2
+    // Two consecutive vectors are 3 registers: (x0,y0) (z0,x1) (y1,z1). op is applied per element to the vectors and
+    // the repeated other vector, the three products are transposed to (x0,x1) (y0,y1) (z0,z1) and added.
+    template<typename OP>
+    void Reduce(const Vector3d* vectors, const size_t count, const Vector3d& other, double* result, OP op)
+    {
+        const double* data = vectors->GetData();
+        const __m128d o0 = _mm_set_pd(other[1], other[0]);
+        const __m128d o1 = _mm_set_pd(other[0], other[2]);
+        const __m128d o2 = _mm_set_pd(other[2], other[1]);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2, data += 6)
+        {
+            const __m128d p0 = op(_mm_loadu_pd(data), o0);
+            const __m128d p1 = op(_mm_loadu_pd(data + 2), o1);
+            const __m128d p2 = op(_mm_loadu_pd(data + 4), o2);
+            const __m128d x = _mm_shuffle_pd(p0, p1, 2);
+            const __m128d y = _mm_shuffle_pd(p0, p2, 1);
+            const __m128d z = _mm_shuffle_pd(p1, p2, 2);
+            _mm_storeu_pd(result + i, _mm_add_pd(_mm_add_pd(x, y), z));
+        }
+        for (; i < count; ++i, data += 3)
+        {
+            double sum = 0;
+            for (int j = 0; j < 3; ++j)
+            {
+                double p;
+                _mm_store_sd(&p, op(_mm_set_sd(data[j]), _mm_set_sd(other[j])));
+                sum += p;
+            }
+            result[i] = sum;
+        }
+    }
+#endif
+}
+
+void VectorBatch::DistancesSquared(const Vector3d* points, const size_t count, const Vector3d& point, double* result)
+{
+#ifdef VECTORBATCH_SSE2
+    Reduce(points, count, point, result, [](const __m128d a, const __m128d b) { const __m128d d = _mm_sub_pd(a, b); return _mm_mul_pd(d, d); });
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[i] = DistanceSquared(points[i], point);
+    }
+#endif
+}
+
+void VectorBatch::Transform(const RotationMatrix3d& matrix, const Vector3d* vectors, const size_t count, Vector3d* result)
+{
+    size_t i = 0;
+#ifdef VECTORBATCH_SSE2
+    // Two consecutive vectors are 3 registers: (x0,y0) (z0,x1) (y1,z1), the result has the same layout. Each
+    // register is the sum of 3 matrix columns (the elements of the rows it holds) times the matching coordinates.
+    auto Column = [&matrix](const int row0, const int row1, const int column)
+    {
+        return _mm_set_pd(matrix[row1][column], matrix[row0][column]);
+    };
+    const __m128d a0 = Column(0, 1, 0), b0 = Column(0, 1, 1), c0 = Column(0, 1, 2);
+    const __m128d a1 = Column(2, 0, 0), b1 = Column(2, 0, 1), c1 = Column(2, 0, 2);
+    const __m128d a2 = Column(1, 2, 0), b2 = Column(1, 2, 1), c2 = Column(1, 2, 2);
+    const double* data = vectors->GetData();
+    double* out = result->GetData();
+    for (; i + 2 <= count; i += 2, data += 6, out += 6)
+    {
+        const __m128d v0 = _mm_loadu_pd(data);
+        const __m128d v1 = _mm_loadu_pd(data + 2);
+        const __m128d v2 = _mm_loadu_pd(data + 4);
+        const __m128d r0 = _mm_add_pd(_mm_add_pd(
+            _mm_mul_pd(a0, _mm_unpacklo_pd(v0, v0)),
+            _mm_mul_pd(b0, _mm_unpackhi_pd(v0, v0))),
+            _mm_mul_pd(c0, _mm_unpacklo_pd(v1, v1)));
+        const __m128d r1 = _mm_add_pd(_mm_add_pd(
+            _mm_mul_pd(a1, _mm_shuffle_pd(v0, v1, 2)),
+            _mm_mul_pd(b1, _mm_shuffle_pd(v0, v2, 1))),
+            _mm_mul_pd(c1, _mm_shuffle_pd(v1, v2, 2)));
+        const __m128d r2 = _mm_add_pd(_mm_add_pd(
+            _mm_mul_pd(a2, _mm_unpackhi_pd(v1, v1)),
+            _mm_mul_pd(b2, _mm_unpacklo_pd(v2, v2))),
+            _mm_mul_pd(c2, _mm_unpackhi_pd(v2, v2)));
+        _mm_storeu_pd(out, r0);
+        _mm_storeu_pd(out + 2, r1);
+        _mm_storeu_pd(out + 4, r2);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        result[i] = matrix.Transform(vectors[i]);
+    }
+}
+
+void VectorBatch::InnerProducts(const Vector3d* vectors, const size_t count, const Vector3d& direction, double* result)
+{
+#ifdef VECTORBATCH_SSE2
+    Reduce(vectors, count, direction, result, [](const __m128d a, const __m128d b) { return _mm_mul_pd(a, b); });
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[i] = vectors[i].InnerProduct(direction);
+    }
+#endif
+}
@@ -21,8 +21,19 @@ public:
     }
     std::vector<unsigned char> GetFont(const std::string& fontName)
     {
-        auto q = m_db.ExecQuery("SELECT Data FROM Fonts WHERE Name = '%1%'", fontName);
-        return q.GetBlobField(0);
+        // stream the font straight into the result, without an intermediate copy
+        std::vector<unsigned char> res;
+        auto q = m_db.ExecQueryParams("SELECT rowid FROM Fonts WHERE Name = ?1", fontName);
+        if (!q.IsEOF())
+        {
+            auto blob = m_db.OpenBlob("Fonts", "Data", q.GetInt64Field(0));
+            res.resize(blob.GetSize());
+            if (!res.empty())
+            {
+                blob.Read(res.data(), (int)res.size());
+            }
+        }
+        return res;
     }
     std::vector<std::string> GetFontNames()
     {
@@ -0,0 +1,101 @@
+#include <array>
+
+using namespace std;
+
+#include "Geometry.h"
+#include "Frustum.h"
+
+using namespace Geometry;
+
+namespace Viewer
+{
+    Frustum::Frustum()
+    {
+        // everything is inside
+        for (size_t i = 0; i < m_planes.size(); ++i)
+        {
+            SetPlane(i, Vector3d(0, 0, 1), std::numeric_limits<double>::infinity());
+        }
+    }
+
+    void Frustum::SetOrthogonal(const double left, const double right, const double bottom, const double top, const double nearVal, const double farVal)
+    {
+        SetPlane(0, Vector3d(1, 0, 0), -left);
+        SetPlane(1, Vector3d(-1, 0, 0), right);
+        SetPlane(2, Vector3d(0, 1, 0), -bottom);
+        SetPlane(3, Vector3d(0, -1, 0), top);
+        SetPlane(4, Vector3d(0, 0, -1), -nearVal);
+        SetPlane(5, Vector3d(0, 0, 1), farVal);
+    }
+
+    void Frustum::SetPerspective(const double left, const double right, const double bottom, const double top, const double nearVal, const double farVal)
+    {
+        // the side planes go through the eye and the edges of the near plane
+        SetPlane(0, Vector3d(nearVal, 0, left), 0);
+        SetPlane(1, Vector3d(-nearVal, 0, -right), 0);
+        SetPlane(2, Vector3d(0, nearVal, bottom), 0);
+        SetPlane(3, Vector3d(0, -nearVal, -top), 0);
+        SetPlane(4, Vector3d(0, 0, -1), -nearVal);
+        SetPlane(5, Vector3d(0, 0, 1), farVal);
+    }
+
+    void Frustum::Transform(const Quat& rotation, const Vector3d& translation)
+    {
+        // n.(t + R(v)) + d = R^-1(n).v + (n.t + d)
+        for (Plane& plane : m_planes)
+        {
+            plane.m_offset += plane.m_normal.InnerProduct(translation);
+            plane.m_normal = rotation.InverseTransform(plane.m_normal);
+        }
+    }
+
+    bool Frustum::IsOutside(const BoundingShape3d& boundingShape) const
+    {
+        // extent(normal) is the extent of the bounding shape along the normal of a plane, seen from its center
+        auto IsOutsidePlane = [this](const Vector3d& center, const auto& extent)
+        {
+            for (const Plane& plane : m_planes)
+            {
+                if (plane.m_normal.InnerProduct(center) + plane.m_offset < -extent(plane.m_normal))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        switch (boundingShape.GetType())
+        {
+        default:
+            return false;
+        case BoundingShape3d::Type::Ball:
+            {
+                const double radius = boundingShape.GetRadius();
+                return IsOutsidePlane(boundingShape.GetCenter(), [radius](const Vector3d& normal) { return radius; });
+            }
+        case BoundingShape3d::Type::Box:
+            {
+                const Vector3d halfExtents = (boundingShape.GetMax() - boundingShape.GetMin()) / 2;
+                return IsOutsidePlane(boundingShape.GetMin() + halfExtents, [&halfExtents](const Vector3d& normal)
+                {
+                    return abs(normal[0]) * halfExtents[0] + abs(normal[1]) * halfExtents[1] + abs(normal[2]) * halfExtents[2];
+                });
+            }
+        case BoundingShape3d::Type::OrientedBox:
+            {
+                const BoundingShape3d::axes_type axes = boundingShape.GetAxes();
+                const Vector3d halfExtents = boundingShape.GetHalfExtents();
+                return IsOutsidePlane(boundingShape.GetCenter(), [&axes, &halfExtents](const Vector3d& normal)
+                {
+                    return abs(normal.InnerProduct(axes[0])) * halfExtents[0] + abs(normal.InnerProduct(axes[1])) * halfExtents[1] + abs(normal.InnerProduct(axes[2])) * halfExtents[2];
+                });
+            }
+        }
+    }
+
+    void Frustum::SetPlane(const size_t index, const Vector3d& normal, const double offset)
+    {
+        const double length = normal.Length();
+        m_planes[index] = { normal / length, offset / length };
+    }
+
+} // Viewer
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace Viewer
+{
+    /* Frustum : the part of the scene inside the view volume, used to skip hulls which can't be seen
+     *
+     * The volume is set up in eye coordinates with the arguments of glOrtho/glFrustum, and then moved into
+     * model coordinates with the modelview transformation (eye = translation + rotation(model)), so bounding
+     * shapes can be tested without transforming them.
+     */
+    class Frustum
+    {
+    public:
+        Frustum();
+
+        void SetOrthogonal(const double left, const double right, const double bottom, const double top, const double nearVal, const double farVal);
+        void SetPerspective(const double left, const double right, const double bottom, const double top, const double nearVal, const double farVal);
+        void Transform(const Geometry::Quat& rotation, const Geometry::Vector3d& translation);
+
+        // true if the bounding shape lies completely outside one of the planes; uninitialized bounding shapes are never outside
+        bool IsOutside(const Geometry::BoundingShape3d& boundingShape) const;
+
+    private:
+        // inside if m_normal.InnerProduct(v) + m_offset >= 0, with m_normal of length 1
+        struct Plane
+        {
+            Geometry::Vector3d m_normal;
+            double m_offset;
+        };
+        std::array<Plane, 6> m_planes;
+
+        void SetPlane(const size_t index, const Geometry::Vector3d& normal, const double offset);
+    };
+
+}; // Viewer
+
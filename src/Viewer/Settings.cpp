@@ -1,7 +1,10 @@
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 using namespace std;
 
@@ -14,9 +17,9 @@ using namespace SQLite;
 #include "Settings.h"
 using namespace Viewer;
 
-// todo: 
-// - SQLite::DB is not threadfriendly. create a worker thread for db work?
-// - replace direct queries with statements to protect against bad input
+// Values are kept in memory; writes to the db are queued and done by a worker thread, so setting a
+// value never waits for the disk. The queue keeps the last value per key only, and each flush writes
+// everything that is queued in a single transaction. The db is only used by the worker after AttachDB.
 
 class SettingsCache
 {
@@ -29,14 +32,19 @@ class SettingsCache
 public:
     SettingsCache()
         : m_maxId(0)
+        , m_attached(false)
+        , m_stop(false)
+        , m_writing(false)
     {}
     ~SettingsCache()
     {
+        StopWorker();
         m_db.Close();
     }
 
     void AttachDB(const std::string & filename) 
     {
+        StopWorker();
         std::lock_guard<std::mutex> lock(m_mutex);
 
         m_maxId = 0;
@@ -79,6 +87,17 @@ public:
             m_doubles.emplace(m_maxId, value);
             ++m_maxId;
         }
+
+        m_attached = true;
+        m_stop = false;
+        m_worker = std::thread([this]() { WorkerLoop(); });
+    }
+
+    // wait until all queued writes are in the db
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_flushed.wait(lock, [this]() { return m_pending.empty() && !m_writing; });
     }
 
     std::string GetString(const std::string& key, const std::string& def) 
@@ -130,14 +149,18 @@ protected:
     template<>
     StoredType GetStoredType<double>() { return StoredType::Double; }
 
-    template<typename T>
-    const char* GetTable() { static_assert(false, "Unsupported StoredType"); }
-    template<>
-    const char* GetTable<std::string>() { return "Strings"; }
-    template<>
-    const char* GetTable<int>() { return "Integers"; }
-    template<>
-    const char* GetTable<double>() { return "Doubles"; }
+    static const char* GetTable(const StoredType type)
+    {
+        switch (type)
+        {
+        case StoredType::String: return "Strings";
+        case StoredType::Int: return "Integers";
+        case StoredType::Double: return "Doubles";
+        default:
+            assert(false); // new type?
+            return "";
+        }
+    }
 
     template<typename T>
     std::unordered_map<unsigned int, T>& GetContainer() { static_assert(false, "Unsupported StoredType"); }
@@ -185,7 +208,7 @@ protected:
             {
                 // Use existing slot
                 GetContainer<T>()[id_iter->second.second] = value;
-                m_db.ExecDML("UPDATE %1% SET Value = '%2%' WHERE Id = '%3%'", GetTable<T>(), value, key);
+                QueueWrite(key, value);
                 return;
             }
             else
@@ -195,15 +218,12 @@ protected:
                 {
                 case StoredType::Double:
                     m_doubles.erase(id_iter->second.second);
-                    m_db.ExecDML("DELETE FROM Strings WHERE Id = '%1%'", key);
                     break;
                 case StoredType::Int:
                     m_ints.erase(id_iter->second.second);
-                    m_db.ExecDML("DELETE FROM Integers WHERE Id = '%1%'", key);
                     break;
                 case StoredType::String:
                     m_strings.erase(id_iter->second.second);
-                    m_db.ExecDML("DELETE FROM Doubles WHERE Id = '%1%'", key);
                     break;
                 default:
                     assert(false); // new type?
@@ -218,7 +238,104 @@ protected:
             ++m_maxId;
         }
         GetContainer<T>().emplace(id_iter->second.second, value);
-        m_db.ExecDML("INSERT INTO %1%(Id,Value) VALUES('%2%','%3%')", GetTable<T>(), key, value);
+        QueueWrite(key, value);
+    }
+
+    // Pending db write for a single key; m_mutex should be locked
+    struct PendingWrite
+    {
+        StoredType m_type;
+        std::string m_string;
+        int m_int;
+        double m_double;
+    };
+
+    void QueueWrite(const std::string& key, const std::string& value) { QueueWrite(key, { StoredType::String, value, 0, 0.0 }); }
+    void QueueWrite(const std::string& key, const int value) { QueueWrite(key, { StoredType::Int, std::string(), value, 0.0 }); }
+    void QueueWrite(const std::string& key, const double value) { QueueWrite(key, { StoredType::Double, std::string(), 0, value }); }
+    void QueueWrite(const std::string& key, PendingWrite&& write)
+    {
+        if (m_attached)
+        {
+            m_pending[key] = std::move(write);
+            m_wakeup.notify_one();
+        }
+    }
+
+    void WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_wakeup.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+            if (m_pending.empty())
+            {
+                return; // stopped
+            }
+            if (!m_stop)
+            {
+                // give a burst of changes (e.g. dragging a slider) the chance to collapse into one write
+                m_wakeup.wait_for(lock, std::chrono::milliseconds(50), [this]() { return m_stop; });
+            }
+            std::unordered_map<std::string, PendingWrite> pending;
+            pending.swap(m_pending);
+            m_writing = true;
+            lock.unlock();
+            WritePending(pending);
+            lock.lock();
+            m_writing = false;
+            m_flushed.notify_all();
+        }
+    }
+
+    void WritePending(const std::unordered_map<std::string, PendingWrite>& pending)
+    {
+        try
+        {
+            m_db.BeginTransaction();
+            for (const auto& write : pending)
+            {
+                // a key lives in one table only; drop it everywhere in case its type changed
+                m_db.ExecDMLParams("DELETE FROM Strings WHERE Id = ?1", write.first);
+                m_db.ExecDMLParams("DELETE FROM Integers WHERE Id = ?1", write.first);
+                m_db.ExecDMLParams("DELETE FROM Doubles WHERE Id = ?1", write.first);
+                const std::string insert = std::string("INSERT INTO ") + GetTable(write.second.m_type) + "(Id,Value) VALUES(?1,?2)";
+                switch (write.second.m_type)
+                {
+                case StoredType::String:
+                    m_db.ExecDMLParams(insert, write.first, write.second.m_string);
+                    break;
+                case StoredType::Int:
+                    m_db.ExecDMLParams(insert, write.first, write.second.m_int);
+                    break;
+                case StoredType::Double:
+                    m_db.ExecDMLParams(insert, write.first, write.second.m_double);
+                    break;
+                default:
+                    assert(false); // new type?
+                    break;
+                }
+            }
+            m_db.CommitTransaction();
+        }
+        catch (const std::exception&)
+        {
+            // settings are best effort; the in memory values stay valid
+            try { m_db.RollbackTransaction(); } catch (const std::exception&) {}
+        }
+    }
+
+    void StopWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_wakeup.notify_one();
+        }
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
     }
 
 private:
@@ -229,6 +346,14 @@ private:
     std::unordered_map<unsigned int, int> m_ints;
     std::unordered_map<unsigned int, double> m_doubles;
     unsigned int m_maxId;
+
+    bool m_attached;
+    bool m_stop;
+    bool m_writing;
+    std::unordered_map<std::string, PendingWrite> m_pending;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_flushed;
+    std::thread m_worker;
 };
 
 namespace
@@ -245,6 +370,11 @@ void Settings::AttachDB(const std::string & filename)
     Cache().AttachDB(filename);
 }
 
+void Settings::Flush()
+{
+    Cache().Flush();
+}
+
 std::string Settings::GetString(const std::string& key, const std::string& def)
 {
     return Cache().GetString(std::move(key), std::move(def));
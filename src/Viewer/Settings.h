@@ -7,6 +7,8 @@ namespace Viewer
     {
     public:
         static void AttachDB(const std::string& filename);
+        // wait until all changed values are written to the db (writing happens in the background)
+        static void Flush();
 
         static std::string GetString(const std::string& key, const std::string& def = "");
         static int GetInt(const std::string& key, const int def = 0);
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <list>
 #include <map>
@@ -15,6 +16,7 @@ using namespace std::chrono_literals;
 #include "Geometry.h"
 #include "GLWrappers.h"
 #include "Font.h"
+#include "Frustum.h"
 #include "Menu.h"
 #include "UserInterface.h"
 #include "RenderObjects.h"
@@ -33,6 +35,8 @@ namespace Viewer
             State()
                 : m_pixelSize(-1)
                 , m_viewingMode(ViewingMode::Perspective)
+                , m_drawnHulls(0)
+                , m_culledHulls(0)
             {
                 SetFontName("Prida");
             }
@@ -111,6 +115,8 @@ namespace Viewer
 
             // rendering
             Geometry::ViewingMode m_viewingMode;
+            size_t m_drawnHulls;    // last frame
+            size_t m_culledHulls;   // last frame, outside the view
 
             // drawable objects
             std::vector<Geometry::ShapePtr> m_shapes;
@@ -246,6 +252,7 @@ namespace Viewer
                 glEnable(GL_LIGHT0);
                 glFrontFace(GL_CCW);
                 glEnable(GL_COLOR_MATERIAL);
+                glEnable(GL_NORMALIZE); // scaled instances
                 glEnable(GL_LIGHTING);
                 glEnable(GL_CULL_FACE);
                 glEnable(GL_DEPTH_TEST);
@@ -399,12 +406,15 @@ namespace Viewer
                     glEnd();
                 }
             };
-            // todo: do not draw patches which are outside the view.
-            //Projection<double> projection;
-            //Vertex front = projection.Project(Vector2d(projection.GetWidth()/2, projection.GetHeight()/2), -100);
-            //front.Normalize();
+            Frustum frustum;
             auto DrawHull = [&](const HullRaw& hull)
             {
+                if (frustum.IsOutside(hull->GetBoundingShape()))
+                {
+                    ++m_culledHulls;
+                    return;
+                }
+                ++m_drawnHulls;
                 HullRenderObject& renderObject = GetRenderObject(hull);
                 unsigned int updateNeeded = renderObject.NeedsUpdate();
                 unsigned int displayList = renderObject.GetDisplayList();
@@ -434,16 +444,34 @@ namespace Viewer
                 {
                     UpdateDisplayList(hull->TryGetLock());
                 }
-                glCallList(displayList);
+                if (hull->IsInstance())
+                {
+                    // the display list contains the shared geometry, place it using the instance transform
+                    const auto& transform = hull->GetInstanceTransform();
+                    const auto& translation = transform.GetTranslation();
+                    glPushMatrix();
+                    glTranslated(translation[0], translation[1], translation[2]);
+                    // glMultMatrix applies the inverse rotation (see DrawShapes)
+                    glMultMatrix(transform.GetRotation().Inverted());
+                    glScaled(transform.GetScale(), transform.GetScale(), transform.GetScale());
+                    glCallList(displayList);
+                    glPopMatrix();
+                }
+                else
+                {
+                    glCallList(displayList);
+                }
             };
 
             // todo: adjust far clipping plane?
             glMatrixMode(GL_PROJECTION);
             glLoadIdentity();
 
+            Vector3d viewTranslation(0, 0, 0);
             if (m_viewingMode == ViewingMode::Orthogonal)
             {
                 glOrtho(-m_ratio / m_zoom, m_ratio / m_zoom, -1. / m_zoom, 1. / m_zoom, -2, 2);
+                frustum.SetOrthogonal(-m_ratio / m_zoom, m_ratio / m_zoom, -1. / m_zoom, 1. / m_zoom, -2, 2);
                 glMatrixMode(GL_MODELVIEW);
                 glLoadIdentity();
             }
@@ -451,13 +479,20 @@ namespace Viewer
             {
                 double scale = 0.9 / m_zoom;
                 glFrustum(-m_ratio * scale, m_ratio * scale, -1. * scale, 1. * scale, 3, 7);
+                frustum.SetPerspective(-m_ratio * scale, m_ratio * scale, -1. * scale, 1. * scale, 3, 7);
                 glMatrixMode(GL_MODELVIEW);
                 glLoadIdentity();
                 gluLookAt(0.0, 0.0, 5.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+                viewTranslation = Vector3d(0, 0, -5); // gluLookAt
             }
 
-            glMultMatrix(CalculateRotation());
+            const Quat rotation = CalculateRotation();
+            glMultMatrix(rotation);
+            // glMultMatrix uses the transposed rotation matrix, i.e. the inverse rotation
+            frustum.Transform(rotation.Inverted(), viewTranslation);
 
+            m_drawnHulls = 0;
+            m_culledHulls = 0;
             for (const Geometry::ShapeRaw& shape : m_shapes)
             {
                 renderInfo.Push(shape);
@@ -495,7 +530,7 @@ namespace Viewer
             if (Settings::GetBool("ShowFPS") && times.size()>13)
             {
                 double f = (times.size() - 1) / (times.back() - times.front());
-                std::string fps = (boost::format("FPS %1$.0f") % f).str();
+                std::string fps = (boost::format("FPS %1$.0f  culled %2%/%3%") % f % m_culledHulls % (m_drawnHulls + m_culledHulls)).str();
                 auto size = m_font->GetSize(fps);
                 m_font->Color(Geometry::Color::Red()).Draw(m_x - size[0] - 2 * m_pixelSize, 2 * m_pixelSize - m_y, fps);
             }